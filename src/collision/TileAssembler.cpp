@@ -20,6 +20,10 @@
 #include "BoundingIntervalHierarchy.h"
 #include "VMapDefinitions.h"
 
+#include <G3D/System.h>
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+
 #include <set>
 #include <iomanip>
 #include <sstream>
@@ -51,8 +55,9 @@ Vector3 ModelPosition::transform(const Vector3& pIn) const
 
     //=================================================================
 
-TileAssembler::TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName)
+TileAssembler::TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName, uint32 pThreads)
 {
+    iThreads = pThreads ? pThreads : 1;
     iCurrentUniqueNameId = 0;
     iFilterMethod = NULL;
     iSrcDir = pSrcDirName;
@@ -66,138 +71,243 @@ TileAssembler::~TileAssembler()
     //delete iCoordModelMapping;
 }
 
-bool TileAssembler::convertWorld2()
+// Runs a TileAssembler job for every index in [0, count) on a number of threads,
+// each thread picks the next free index until all are done or one job failed
+class TileAssemblerTask : public ACE_Task_Base
 {
-    bool success = readMapSpawns();
-    if (!success)
-        return false;
+    public:
+        typedef bool (TileAssembler::*Job)(uint32 index);
 
-    // export Map data
-    for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end() && success; ++map_iter)
-    {
-        // build global map tree
-        std::vector<ModelSpawn*> mapSpawns;
-        UniqueEntryMap::iterator entry;
-        printf("Calculating model bounds for map %u...\n", map_iter->first);
-        for (entry = map_iter->second->UniqueEntries.begin(); entry != map_iter->second->UniqueEntries.end(); ++entry)
+        TileAssemblerTask(TileAssembler* assembler, Job job, uint32 count)
+            : iAssembler(assembler), iJob(job), iCount(count), iNext(0), iSuccess(true) {}
+
+        bool run(uint32 threads)
         {
-            // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
-            if (entry->second.flags & MOD_M2)
-            {
-                if (!calculateTransformedBound(entry->second))
-                    break;
-            }
-            else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
+            if (threads > iCount)
+                threads = iCount;
+
+            if (threads <= 1)
+                svc();
+            else if (activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(threads)) == -1)
             {
-                // @todo: remove extractor hack and uncomment below line:
-                //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                entry->second.iBound = entry->second.iBound + Vector3(533.33333f * 32, 533.33333f * 32, 0.f);
+                printf("Cannot start %u threads, converting on a single one\n", threads);
+                svc();
             }
-            mapSpawns.push_back(&(entry->second));
-            spawnedModelFiles.insert(entry->second.name);
-        }
-
-        printf("Creating map tree for map %u...\n", map_iter->first);
-        BIH pTree;
-        pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
-
-        // ===> possibly move this code to StaticMapTree class
-        std::map<uint32, uint32> modelNodeIdx;
-        for (uint32 i = 0; i < mapSpawns.size(); ++i)
-            modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+            else
+                wait();
 
-        // write map tree file
-        std::stringstream mapfilename;
-        mapfilename << iDestDir << '/' << std::setfill('0') << std::setw(3) << map_iter->first << ".vmtree";
-        FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
-        if (!mapfile)
-        {
-            success = false;
-            printf("Cannot open %s\n", mapfilename.str().c_str());
-            break;
+            return iSuccess;
         }
 
-        //general info
-        if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
-        uint32 globalTileID = StaticMapTree::packTileID(65, 65);
-        pair<TileMap::iterator, TileMap::iterator> globalRange = map_iter->second->TileEntries.equal_range(globalTileID);
-        char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
-        if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
-        // Nodes
-        if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
-        if (success) success = pTree.writeToFile(mapfile);
-        // global map spawns (WDT), if any (most instances)
-        if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
-
-        for (TileMap::iterator glob = globalRange.first; glob != globalRange.second && success; ++glob)
-            success = ModelSpawn::writeToFile(mapfile, map_iter->second->UniqueEntries[glob->second]);
-
-        fclose(mapfile);
-
-        // <====
-
-        // write map tile files, similar to ADT files, only with extra BSP tree node info
-        TileMap& tileEntries = map_iter->second->TileEntries;
-        TileMap::iterator tile;
-        for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+        int svc()
         {
-            const ModelSpawn& spawn = map_iter->second->UniqueEntries[tile->second];
-            if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
-                continue;
-            uint32 nSpawns = tileEntries.count(tile->first);
-            std::stringstream tilefilename;
-            tilefilename.fill('0');
-            tilefilename << iDestDir << '/' << std::setw(3) << map_iter->first << '_';
-            uint32 x, y;
-            StaticMapTree::unpackTileID(tile->first, x, y);
-            tilefilename << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
-            FILE* tilefile = fopen(tilefilename.str().c_str(), "wb");
-            // file header
-            if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
-            // write number of tile spawns
-            if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
-            // write tile spawns
-            for (uint32 s = 0; s < nSpawns; ++s)
+            while (true)
             {
-                if (s)
+                uint32 index;
+                {
+                    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLock, 0);
+                    if (!iSuccess || iNext >= iCount)
+                        return 0;
+                    index = iNext++;
+                }
+
+                if (!(iAssembler->*iJob)(index))
                 {
-                    ++tile;
-                    if (tile == tileEntries.end())
-                        break;
+                    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLock, 0);
+                    iSuccess = false;
                 }
-                const ModelSpawn& spawn2 = map_iter->second->UniqueEntries[tile->second];
-                success = success && ModelSpawn::writeToFile(tilefile, spawn2);
-                // MapTree nodes to update when loading tile:
-                std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
-                if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
             }
-            fclose(tilefile);
         }
-            // break; //test, extract only first map; TODO: remvoe this line
-    }
+
+    private:
+        TileAssembler* iAssembler;
+        Job iJob;
+        uint32 iCount;
+        uint32 iNext;
+        bool iSuccess;
+        ACE_Thread_Mutex iLock;
+};
+
+bool TileAssembler::convertWorld2()
+{
+    G3D::RealTime stageStart = G3D::System::time();
+    bool success = readMapSpawns();
+    if (!success)
+        return false;
+    G3D::RealTime readTime = G3D::System::time() - stageStart;
+
+    // export Map data, one map per thread
+    stageStart = G3D::System::time();
+    for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        iMapsToConvert.push_back(map_iter->first);
+
+    TileAssemblerTask mapTask(this, &TileAssembler::convertMap, iMapsToConvert.size());
+    success = mapTask.run(iThreads);
+    G3D::RealTime mapTime = G3D::System::time() - stageStart;
 
     // add an object models, listed in temp_gameobject_models file
-    exportGameobjectModels();
+    stageStart = G3D::System::time();
+    if (success)
+        exportGameobjectModels();
+    G3D::RealTime gameobjectTime = G3D::System::time() - stageStart;
+
     // export objects
-    std::cout << "\nConverting Model Files" << std::endl;
-    for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
+    stageStart = G3D::System::time();
+    if (success)
     {
-        std::cout << "Converting " << *mfile << std::endl;
-        if (!convertRawFile(*mfile))
-        {
-            std::cout << "error converting " << *mfile << std::endl;
-            success = false;
-            break;
-        }
+        std::cout << "\nConverting Model Files" << std::endl;
+        iModelsToConvert.assign(spawnedModelFiles.begin(), spawnedModelFiles.end());
+
+        TileAssemblerTask modelTask(this, &TileAssembler::convertModel, iModelsToConvert.size());
+        success = modelTask.run(iThreads);
     }
+    G3D::RealTime modelTime = G3D::System::time() - stageStart;
 
     //cleanup:
     for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
         delete map_iter->second;
 
+    printf("\nStage times using %u threads:\n", iThreads);
+    printf("  reading spawns:            %8.2f s\n", readTime);
+    printf("  map trees and tiles:       %8.2f s (%u maps)\n", mapTime, uint32(iMapsToConvert.size()));
+    printf("  gameobject models:         %8.2f s\n", gameobjectTime);
+    printf("  model files:               %8.2f s (%u models)\n", modelTime, uint32(iModelsToConvert.size()));
+
     return success;
 }
 
+bool TileAssembler::convertMap(uint32 index)
+{
+    uint32 mapID = iMapsToConvert[index];
+    MapData::iterator map_iter = mapData.find(mapID);
+    MapSpawns* spawns = map_iter->second;
+    bool success = true;
+
+    // build global map tree
+    std::vector<ModelSpawn*> mapSpawns;
+    std::set<std::string> modelFiles;
+    UniqueEntryMap::iterator entry;
+    printf("Calculating model bounds for map %u...\n", mapID);
+    for (entry = spawns->UniqueEntries.begin(); entry != spawns->UniqueEntries.end(); ++entry)
+    {
+        // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
+        if (entry->second.flags & MOD_M2)
+        {
+            if (!calculateTransformedBound(entry->second))
+                break;
+        }
+        else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
+        {
+            // @todo: remove extractor hack and uncomment below line:
+            //entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
+            entry->second.iBound = entry->second.iBound + Vector3(533.33333f * 32, 533.33333f * 32, 0.f);
+        }
+
+        mapSpawns.push_back(&(entry->second));
+        modelFiles.insert(entry->second.name);
+    }
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iModelFilesLock, false);
+        spawnedModelFiles.insert(modelFiles.begin(), modelFiles.end());
+    }
+
+    printf("Creating map tree for map %u...\n", mapID);
+    BIH pTree;
+    pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
+
+    // ===> possibly move this code to StaticMapTree class
+    std::map<uint32, uint32> modelNodeIdx;
+    for (uint32 i = 0; i < mapSpawns.size(); ++i)
+        modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i));
+
+    // write map tree file
+    std::stringstream mapfilename;
+    mapfilename << iDestDir << '/' << std::setfill('0') << std::setw(3) << mapID << ".vmtree";
+    FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
+    if (!mapfile)
+    {
+        printf("Cannot open %s\n", mapfilename.str().c_str());
+        return false;
+    }
+
+    //general info
+    if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) success = false;
+    uint32 globalTileID = StaticMapTree::packTileID(65, 65);
+    pair<TileMap::iterator, TileMap::iterator> globalRange = spawns->TileEntries.equal_range(globalTileID);
+    char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
+    if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) success = false;
+    // Nodes
+    if (success && fwrite("NODE", 4, 1, mapfile) != 1) success = false;
+    if (success) success = pTree.writeToFile(mapfile);
+    // global map spawns (WDT), if any (most instances)
+    if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) success = false;
+
+    for (TileMap::iterator glob = globalRange.first; glob != globalRange.second && success; ++glob)
+        success = ModelSpawn::writeToFile(mapfile, spawns->UniqueEntries[glob->second]);
+
+    fclose(mapfile);
+
+    // <====
+
+    // write map tile files, similar to ADT files, only with extra BSP tree node info
+    TileMap& tileEntries = spawns->TileEntries;
+    TileMap::iterator tile;
+    for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+    {
+        const ModelSpawn& spawn = spawns->UniqueEntries[tile->second];
+        if (spawn.flags & MOD_WORLDSPAWN) // WDT spawn, saved as tile 65/65 currently...
+            continue;
+        uint32 nSpawns = tileEntries.count(tile->first);
+        std::stringstream tilefilename;
+        tilefilename.fill('0');
+        tilefilename << iDestDir << '/' << std::setw(3) << mapID << '_';
+        uint32 x, y;
+        StaticMapTree::unpackTileID(tile->first, x, y);
+        tilefilename << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
+        FILE* tilefile = fopen(tilefilename.str().c_str(), "wb");
+        // file header
+        if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) success = false;
+        // write number of tile spawns
+        if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) success = false;
+        // write tile spawns
+        for (uint32 s = 0; s < nSpawns; ++s)
+        {
+            if (s)
+            {
+                ++tile;
+                if (tile == tileEntries.end())
+                    break;
+            }
+            const ModelSpawn& spawn2 = spawns->UniqueEntries[tile->second];
+            success = success && ModelSpawn::writeToFile(tilefile, spawn2);
+            // MapTree nodes to update when loading tile:
+            std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
+            if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) success = false;
+        }
+        fclose(tilefile);
+    }
+
+    // spawns are not needed after the map is written, free them early
+    // instead of keeping every map in memory until the end
+    delete spawns;
+    map_iter->second = NULL;
+
+    return success;
+}
+
+bool TileAssembler::convertModel(uint32 index)
+{
+    std::string const& modelFile = iModelsToConvert[index];
+    printf("Converting %s\n", modelFile.c_str());
+    if (!convertRawFile(modelFile))
+    {
+        printf("error converting %s\n", modelFile.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool TileAssembler::readMapSpawns()
 {
     std::string fname = iSrcDir + "/dir_bin";
@@ -22,6 +22,7 @@
 #include <G3D/Matrix3.h>
 #include <map>
 #include <set>
+#include <ace/Thread_Mutex.h>
 
 #include "ModelInstance.h"
 #include "WorldModel.h"
@@ -97,12 +98,19 @@ class TileAssembler
         unsigned int iCurrentUniqueNameId;
         MapData mapData;
         std::set<std::string> spawnedModelFiles;
+        ACE_Thread_Mutex iModelFilesLock;                   // guards spawnedModelFiles while maps are converted
+
+        uint32 iThreads;
+        std::vector<uint32> iMapsToConvert;
+        std::vector<std::string> iModelsToConvert;
 
     public:
-        TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
+        TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName, uint32 pThreads = 1);
         virtual ~TileAssembler();
 
         bool convertWorld2();
+        bool convertMap(uint32 index);                      // map tree and tile files of one map
+        bool convertModel(uint32 index);                    // one model file
         bool readMapSpawns();
         bool calculateTransformedBound(ModelSpawn& spawn);
         void exportGameobjectModels();
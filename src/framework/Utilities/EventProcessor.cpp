@@ -17,15 +17,34 @@
 
 #include "EventProcessor.h"
 
+#include <cstring>
+
+bool EventProcessor::EventBefore(BasicEvent const* a, BasicEvent const* b)
+{
+    if (a->m_execTime != b->m_execTime)
+        return a->m_execTime < b->m_execTime;
+
+    return a->m_sequence < b->m_sequence;
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
     m_aborting = false;
+    m_due = NULL;
+    m_dueTail = NULL;
+    m_wheel = NULL;
+    m_overflow = NULL;
+    m_wheelTime = 0;
+    m_sequence = 0;
+    m_wheelSize = 0;
+    memset(m_levelSize, 0, sizeof(m_levelSize));
 }
 
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
+    delete[] m_wheel;
 }
 
 void EventProcessor::Update(uint32 p_time)
@@ -34,27 +53,171 @@ void EventProcessor::Update(uint32 p_time)
     m_time += p_time;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    for (;;)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
-
-        if (!Event->to_Abort)
+        while (m_due && m_due->m_execTime <= m_time)
         {
-            if (Event->Execute(m_time, p_time))
+            // get and remove event from queue
+            BasicEvent* Event = m_due;
+            m_due = Event->m_nextEvent;
+            if (!m_due)
+                m_dueTail = NULL;
+            Event->m_nextEvent = NULL;
+
+            if (!Event->to_Abort)
             {
-                // completely destroy event if it is not re-added
+                if (Event->Execute(m_time, p_time))
+                {
+                    // completely destroy event if it is not re-added
+                    delete Event;
+                }
+            }
+            else
+            {
+                Event->Abort(m_time);
                 delete Event;
             }
         }
-        else
+
+        if (m_wheelTime > m_time)
+            break;
+
+        Advance();
+    }
+}
+
+void EventProcessor::Advance()
+{
+    const uint64 tick = uint64(1) << EVENT_WHEEL_TICK_BITS;
+    const uint64 turn = uint64(1) << LevelShift(1);
+
+    // nothing scheduled ahead, jump right past the current time
+    if (!m_wheelSize)
+    {
+        m_wheelTime = ((m_time >> EVENT_WHEEL_TICK_BITS) + 1) << EVENT_WHEEL_TICK_BITS;
+        return;
+    }
+
+    if (!(m_wheelTime & (turn - 1)))
+    {
+        // the first level wrapped around, pull the next buckets down
+        if (!(m_wheelTime & ((uint64(1) << LevelShift(EVENT_WHEEL_LEVELS)) - 1)))
         {
-            Event->Abort(m_time);
-            delete Event;
+            BasicEvent* Event = m_overflow;
+            m_overflow = NULL;
+            while (Event)
+            {
+                BasicEvent* next = Event->m_nextEvent;
+                --m_wheelSize;
+                Schedule(Event);
+                Event = next;
+            }
         }
+
+        for (uint32 level = EVENT_WHEEL_LEVELS - 1; level > 0; --level)
+            if (!(m_wheelTime & ((uint64(1) << LevelShift(level)) - 1)))
+                Cascade(level, uint32(m_wheelTime >> LevelShift(level)) & EVENT_WHEEL_SLOT_MASK);
+    }
+    else if (!m_levelSize[0])
+    {
+        // skip empty buckets, but never past the next cascade
+        uint64 next = (m_wheelTime | (turn - 1)) + 1;
+        uint64 now = ((m_time >> EVENT_WHEEL_TICK_BITS) + 1) << EVENT_WHEEL_TICK_BITS;
+        m_wheelTime = next < now ? next : now;
+        return;
+    }
+
+    BasicEvent*& bucket = m_wheel[uint32(m_wheelTime >> EVENT_WHEEL_TICK_BITS) & EVENT_WHEEL_SLOT_MASK];
+    BasicEvent* Event = bucket;
+    bucket = NULL;
+    m_wheelTime += tick;
+
+    while (Event)
+    {
+        BasicEvent* next = Event->m_nextEvent;
+        --m_levelSize[0];
+        --m_wheelSize;
+        QueueDue(Event);
+        Event = next;
+    }
+}
+
+void EventProcessor::Cascade(uint32 level, uint32 slot)
+{
+    BasicEvent*& bucket = m_wheel[level * EVENT_WHEEL_SLOTS + slot];
+    BasicEvent* Event = bucket;
+    bucket = NULL;
+
+    while (Event)
+    {
+        BasicEvent* next = Event->m_nextEvent;
+        --m_levelSize[level];
+        --m_wheelSize;
+        Schedule(Event);
+        Event = next;
+    }
+}
+
+void EventProcessor::Schedule(BasicEvent* Event)
+{
+    if (Event->m_execTime < m_wheelTime)
+    {
+        QueueDue(Event);
+        return;
+    }
+
+    if (!m_wheel)
+    {
+        m_wheel = new BasicEvent*[EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS];
+        memset(m_wheel, 0, sizeof(BasicEvent*) * EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS);
+    }
+
+    ++m_wheelSize;
+
+    uint64 delta = Event->m_execTime - m_wheelTime;
+    for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        if (delta >= (uint64(1) << LevelShift(level + 1)))
+            continue;
+
+        BasicEvent*& bucket = m_wheel[level * EVENT_WHEEL_SLOTS + (uint32(Event->m_execTime >> LevelShift(level)) & EVENT_WHEEL_SLOT_MASK)];
+        Event->m_nextEvent = bucket;
+        bucket = Event;
+        ++m_levelSize[level];
+        return;
+    }
+
+    Event->m_nextEvent = m_overflow;
+    m_overflow = Event;
+}
+
+void EventProcessor::QueueDue(BasicEvent* Event)
+{
+    // mostly appended, buckets hold only a few events
+    if (!m_due || !EventBefore(Event, m_dueTail))
+    {
+        Event->m_nextEvent = NULL;
+        if (m_dueTail)
+            m_dueTail->m_nextEvent = Event;
+        else
+            m_due = Event;
+        m_dueTail = Event;
+        return;
     }
+
+    if (EventBefore(Event, m_due))
+    {
+        Event->m_nextEvent = m_due;
+        m_due = Event;
+        return;
+    }
+
+    BasicEvent* prev = m_due;
+    while (!EventBefore(Event, prev->m_nextEvent))
+        prev = prev->m_nextEvent;
+
+    Event->m_nextEvent = prev->m_nextEvent;
+    prev->m_nextEvent = Event;
 }
 
 void EventProcessor::KillAllEvents(bool force)
@@ -63,32 +226,56 @@ void EventProcessor::KillAllEvents(bool force)
     m_aborting = true;
 
     // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
-    {
-        EventList::iterator i_old = i;
-        ++i;
+    AbortList(m_due, force);
+
+    m_dueTail = m_due;
+    while (m_dueTail && m_dueTail->m_nextEvent)
+        m_dueTail = m_dueTail->m_nextEvent;
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
+    if (m_wheel)
+    {
+        for (uint32 level = 0; level < EVENT_WHEEL_LEVELS; ++level)
         {
-            delete i_old->second;
+            for (uint32 slot = 0; slot < EVENT_WHEEL_SLOTS; ++slot)
+            {
+                uint32 removed = AbortList(m_wheel[level * EVENT_WHEEL_SLOTS + slot], force);
+                m_levelSize[level] -= removed;
+                m_wheelSize -= removed;
+            }
+        }
+    }
 
-            if (!force)                                      // need per-element cleanup
-                m_events.erase (i_old);
+    m_wheelSize -= AbortList(m_overflow, force);
+}
+
+uint32 EventProcessor::AbortList(BasicEvent*& list, bool force)
+{
+    uint32 removed = 0;
+    BasicEvent** link = &list;
+
+    while (BasicEvent* Event = *link)
+    {
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
+        {
+            *link = Event->m_nextEvent;
+            delete Event;
+            ++removed;
         }
+        else                                                // kept until the next update deletes it
+            link = &Event->m_nextEvent;
     }
 
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
+    return removed;
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime) Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_sequence = m_sequence++;
+    Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset)
@@ -20,16 +20,17 @@
 
 #include "Platform/Define.h"
 
-#include<map>
-
 // Note. All times are in milliseconds here.
 
 class BasicEvent
 {
+    friend class EventProcessor;
+
     public:
         BasicEvent()
         {
             to_Abort = false;
+            m_nextEvent = NULL;
         }
         virtual ~BasicEvent()                               // override destructor to perform some actions on event removal
         {
@@ -56,9 +57,27 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+    private:
+        // intrusive link, events are queued without any allocation
+        BasicEvent* m_nextEvent;
+        uint64 m_sequence;                                  // insertion order, keeps events with equal m_execTime in FIFO order
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+// Events are kept in a hierarchical timing wheel: every level has
+// EVENT_WHEEL_SLOTS buckets, a bucket of a level covers a full turn of the
+// level below it. Buckets of the first level are drained into a small sorted
+// queue when their time comes, the others are cascaded one level down when
+// the level below wraps around. Events further away than the last level
+// covers wait in an overflow bucket.
+enum EventWheel
+{
+    EVENT_WHEEL_LEVELS      = 3,
+    EVENT_WHEEL_SLOT_BITS   = 5,
+    EVENT_WHEEL_SLOTS       = 1 << EVENT_WHEEL_SLOT_BITS,
+    EVENT_WHEEL_SLOT_MASK   = EVENT_WHEEL_SLOTS - 1,
+    EVENT_WHEEL_TICK_BITS   = 4                         // first level buckets are 16ms wide
+};
 
 class EventProcessor
 {
@@ -72,8 +91,26 @@ class EventProcessor
         uint64 CalculateTime(uint64 t_offset);
     protected:
         uint64 m_time;
-        EventList m_events;
         bool m_aborting;
+
+    private:
+        void Schedule(BasicEvent* Event);
+        void QueueDue(BasicEvent* Event);
+        void Cascade(uint32 level, uint32 slot);
+        void Advance();
+        uint32 AbortList(BasicEvent*& list, bool force);
+
+        static bool EventBefore(BasicEvent const* a, BasicEvent const* b);
+        static uint32 LevelShift(uint32 level) { return EVENT_WHEEL_TICK_BITS + level * EVENT_WHEEL_SLOT_BITS; }
+
+        BasicEvent* m_due;                                  // events before m_wheelTime, sorted by time
+        BasicEvent* m_dueTail;
+        BasicEvent** m_wheel;                               // EVENT_WHEEL_LEVELS * EVENT_WHEEL_SLOTS buckets, allocated on first use
+        BasicEvent* m_overflow;
+        uint64 m_wheelTime;                                 // start of the first bucket not yet drained
+        uint64 m_sequence;
+        uint32 m_wheelSize;                                 // events in m_wheel and m_overflow
+        uint32 m_levelSize[EVENT_WHEEL_LEVELS];
 };
 #endif
 
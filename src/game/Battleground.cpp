@@ -211,8 +211,7 @@ Battleground::~Battleground()
     if (GetInstanceID())                                     // not spam by useless queries in case BG templates
     {
         // delete creature and go respawn times
-        WorldDatabase.PExecute("DELETE FROM creature_respawn WHERE instance = '%u'", GetInstanceID());
-        WorldDatabase.PExecute("DELETE FROM gameobject_respawn WHERE instance = '%u'", GetInstanceID());
+        sObjectMgr.DeleteRespawnTimeForInstance(GetInstanceID());
         // delete instance from db
         CharacterDatabase.PExecute("DELETE FROM instance WHERE id = '%u'", GetInstanceID());
         // remove from battlegrounds
@@ -221,7 +220,10 @@ Battleground::~Battleground()
     sBattlegroundMgr.RemoveBattleground(GetInstanceID());
     // unload map
     if (m_Map)
+    {
+        m_Map->SetBG(NULL);
         m_Map->SetUnload();
+    }
     // remove from bg free slot queue
     this->RemoveFromBGFreeSlotQueue();
 
@@ -237,40 +239,7 @@ void Battleground::Update(uint32 diff)
 
     m_StartTime += diff;
 
-    // WorldPacket data;
-
-    if (GetRemovedPlayersSize())
-    {
-        for (std::map<uint64, uint8>::iterator itr = m_RemovedPlayers.begin(); itr != m_RemovedPlayers.end(); ++itr)
-        {
-            Player* plr = sObjectMgr.GetPlayer(itr->first);
-            switch (itr->second)
-            {
-            //following code is handled by event:
-            /*case 0:
-                sBattlegroundMgr.m_BattlegroundQueues[GetTypeID()].RemovePlayer(itr->first);
-                //RemovePlayerFromQueue(itr->first);
-                if (plr)
-                {
-                    sBattlegroundMgr.BuildBattlegroundStatusPacket(&data, this, plr->GetTeam(), plr->GetBattlegroundQueueIndex(m_TypeID), STATUS_NONE, 0, 0);
-                    plr->GetSession()->SendPacket(&data);
-                }
-                break;*/
-            case 1:                                     // currently in bg and was removed from bg
-                if (plr)
-                    RemovePlayerAtLeave(itr->first, true, true);
-                else
-                    RemovePlayerAtLeave(itr->first, false, false);
-                break;
-            case 2:                                     // revive queue
-                RemovePlayerFromResurrectQueue(itr->first);
-                break;
-            default:
-                sLog.outError("Battleground: Unknown remove player case!");
-            }
-        }
-        m_RemovedPlayers.clear();
-    }
+    // players in m_RemovedPlayers are removed by ProcessRemovedPlayers() on the world thread
 
     // remove offline players from bg after 5 minutes
     if (GetPlayersSize())
@@ -475,6 +444,42 @@ void Battleground::Update(uint32 diff)
     }
 }
 
+void Battleground::ProcessRemovedPlayers()
+{
+    if (!GetRemovedPlayersSize())
+        return;
+
+    for (std::map<uint64, uint8>::iterator itr = m_RemovedPlayers.begin(); itr != m_RemovedPlayers.end(); ++itr)
+    {
+        Player* plr = sObjectMgr.GetPlayer(itr->first);
+        switch (itr->second)
+        {
+        //following code is handled by event:
+        /*case 0:
+            sBattlegroundMgr.m_BattlegroundQueues[GetTypeID()].RemovePlayer(itr->first);
+            //RemovePlayerFromQueue(itr->first);
+            if (plr)
+            {
+                sBattlegroundMgr.BuildBattlegroundStatusPacket(&data, this, plr->GetTeam(), plr->GetBattlegroundQueueIndex(m_TypeID), STATUS_NONE, 0, 0);
+                plr->GetSession()->SendPacket(&data);
+            }
+            break;*/
+        case 1:                                     // currently in bg and was removed from bg
+            if (plr)
+                RemovePlayerAtLeave(itr->first, true, true);
+            else
+                RemovePlayerAtLeave(itr->first, false, false);
+            break;
+        case 2:                                     // revive queue
+            RemovePlayerFromResurrectQueue(itr->first);
+            break;
+        default:
+            sLog.outError("Battleground: Unknown remove player case!");
+        }
+    }
+    m_RemovedPlayers.clear();
+}
+
 void Battleground::SetTeamStartLoc(uint32 TeamID, float X, float Y, float Z, float O)
 {
     uint8 idx = GetTeamIndexByTeamId(TeamID);
@@ -847,7 +852,7 @@ void Battleground::EndBattleground(uint32 winner)
     }
 
     // inform invited players about the removal
-    sBattlegroundMgr.m_BattlegroundQueues[sBattlegroundMgr.BGQueueTypeId(GetTypeID(), GetArenaType())].BGEndedRemoveInvites(this);
+    RemoveQueueInvites();
 
     if (winmsg_id)
         SendMessageToAll(winmsg_id, CHAT_MSG_BG_SYSTEM_NEUTRAL);
@@ -1261,6 +1266,13 @@ void Battleground::EventPlayerLoggedOut(Player* player)
 /* This method should be called only once ... it adds pointer to queue */
 void Battleground::AddToBGFreeSlotQueue()
 {
+    // the free slot queues are used by the queue updates on the world thread
+    if (!sBattlegroundMgr.IsInWorldThread())
+    {
+        sBattlegroundMgr.ScheduleTask(BG_TASK_ADD_FREE_SLOT, GetInstanceID());
+        return;
+    }
+
     // make sure to add only once
     if (!m_InBGFreeSlotQueue)
     {
@@ -1272,6 +1284,12 @@ void Battleground::AddToBGFreeSlotQueue()
 /* This method removes this battleground from free queue - it must be called when deleting battleground - not used now*/
 void Battleground::RemoveFromBGFreeSlotQueue()
 {
+    if (!sBattlegroundMgr.IsInWorldThread())
+    {
+        sBattlegroundMgr.ScheduleTask(BG_TASK_REMOVE_FREE_SLOT, GetInstanceID());
+        return;
+    }
+
     // set to be able to re-add if needed
     m_InBGFreeSlotQueue = false;
     // uncomment this code when battlegrounds will work like instances
@@ -1285,6 +1303,17 @@ void Battleground::RemoveFromBGFreeSlotQueue()
     }
 }
 
+void Battleground::RemoveQueueInvites()
+{
+    if (!sBattlegroundMgr.IsInWorldThread())
+    {
+        sBattlegroundMgr.ScheduleTask(BG_TASK_REMOVE_INVITES, GetInstanceID());
+        return;
+    }
+
+    sBattlegroundMgr.m_BattlegroundQueues[sBattlegroundMgr.BGQueueTypeId(GetTypeID(), GetArenaType())].BGEndedRemoveInvites(this);
+}
+
 // get the number of free slots for team
 // works in similar way that HasFreeSlotsForTeam did, but this is needed for join as group
 uint32 Battleground::GetFreeSlotsForTeam(uint32 Team) const
@@ -1716,7 +1745,7 @@ void Battleground::EndNow()
     SetStatus(STATUS_WAIT_LEAVE);
     SetEndTime(TIME_TO_AUTOREMOVE);
     // inform invited players about the removal
-    sBattlegroundMgr.m_BattlegroundQueues[sBattlegroundMgr.BGQueueTypeId(GetTypeID(), GetArenaType())].BGEndedRemoveInvites(this);
+    RemoveQueueInvites();
 }
 
 // Battleground messages are localized using the dbc lang, they are not client language dependent
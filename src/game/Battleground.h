@@ -454,6 +454,7 @@ class Battleground
 
         void AddToBGFreeSlotQueue();                        //this queue will be useful when more battlegrounds instances will be available
         void RemoveFromBGFreeSlotQueue();                   //this method could delete whole BG instance, if another free is available
+        void RemoveQueueInvites();                          //informs invited players that the BG ended
 
         void _CheckSafePositions(uint32 diff);
         void SetStartMaxDist(float startMaxDist) { m_StartMaxDist = startMaxDist; }
@@ -504,6 +505,8 @@ class Battleground
         {
             return m_RemovedPlayers.size();
         }
+        // called by BattlegroundMgr::Update, leaving players touch the queues and groups
+        void ProcessRemovedPlayers();
 
         typedef std::map<uint64, BattlegroundScore*> BattlegroundScoreMap;
         BattlegroundScoreMap::const_iterator GetPlayerScoresBegin() const
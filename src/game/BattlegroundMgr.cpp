@@ -34,6 +34,7 @@
 #include "Chat.h"
 #include "ArenaTeam.h"
 #include "DisableMgr.h"
+#include "TickProfiler.h"
 
 INSTANTIATE_SINGLETON_1(BattlegroundMgr);
 
@@ -41,7 +42,7 @@ INSTANTIATE_SINGLETON_1(BattlegroundMgr);
 /***           BATTLEGROUND QUEUE SYSTEM              ***/
 /*********************************************************/
 
-BattlegroundQueue::BattlegroundQueue()
+BattlegroundQueue::BattlegroundQueue() : m_JoinSequence(0)
 {
     //queues are empty, we don't have to call clear()
     /*   for (int i = 0; i < MAX_BATTLEGROUND_QUEUES; i++)
@@ -60,38 +61,78 @@ BattlegroundQueue::~BattlegroundQueue()
         for (QueuedGroupsList::iterator itr = m_QueuedGroups[i].begin(); itr != m_QueuedGroups[i].end(); ++itr)
             delete (*itr);
         m_QueuedGroups[i].clear();
+        m_WaitingGroups[i].clear();
+        m_RatedGroups[i].clear();
     }
 }
 
-// initialize eligible groups from the given source matching the given specifications
-void BattlegroundQueue::EligibleGroups::Init(BattlegroundQueue::QueuedGroupsList* source, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType, bool IsRated, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime, uint32 excludeTeam)
+// checks of EligibleGroups::Init besides the rating, for a group that is not invited yet
+static bool IsEligibleGroup(GroupQueueInfo const* ginfo, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType, bool IsRated, uint32 excludeTeam)
+{
+    return ginfo->BgTypeId == BgTypeId &&       // bg type must match
+           ginfo->ArenaType == ArenaType &&     // arena type must match
+           ginfo->IsRated == IsRated &&         // israted must match
+           ginfo->Team == side &&               // match side
+           ginfo->Players.size() <= MaxPlayers &&   // the group must fit in the bg
+           (!excludeTeam || ginfo->ArenaTeamId != excludeTeam) &&  // if excludeTeam is specified, leave out those arena team ids
+           (!IsRated || ginfo->Players.size() == MaxPlayers);      // if rated, then pass only if the player count is exact NEEDS TESTING! (but now this should never happen)
+}
+
+static bool JoinedBefore(GroupQueueInfo const* left, GroupQueueInfo const* right)
+{
+    return left->JoinSequence < right->JoinSequence;
+}
+
+// initialize eligible groups of the given bracket matching the given specifications, in join order
+void BattlegroundQueue::EligibleGroups::Init(BattlegroundQueue* queue, uint32 queue_id, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType, bool IsRated, uint32 MinRating, uint32 MaxRating, uint32 DisregardTime, uint32 excludeTeam)
 {
     // clear from prev initialization
     clear();
-    BattlegroundQueue::QueuedGroupsList::iterator itr, next;
-    // iterate through the source
-    for (itr = source->begin(); itr != source->end(); itr = next)
+
+    // already invited groups are not in the waiting list
+    QueuedGroupsList const& waiting = queue->m_WaitingGroups[queue_id];
+    QueuedGroupsList::const_iterator itr = waiting.begin();
+
+    // without a rating window every waiting group can match
+    if (!IsRated || !DisregardTime)
     {
-        next = itr;
-        ++next;
-        if ((*itr)->BgTypeId == BgTypeId &&     // bg type must match
-            (*itr)->ArenaType == ArenaType &&   // arena type must match
-            (*itr)->IsRated == IsRated &&       // israted must match
-            (*itr)->IsInvitedToBGInstanceGUID == 0 && // leave out already invited groups
-            (*itr)->Team == side &&             // match side
-            (*itr)->Players.size() <= MaxPlayers &&   // the group must fit in the bg
-            (!excludeTeam || (*itr)->ArenaTeamId != excludeTeam) && // if excludeTeam is specified, leave out those arena team ids
-            (!IsRated || (*itr)->Players.size() == MaxPlayers) &&   // if rated, then pass only if the player count is exact NEEDS TESTING! (but now this should never happen)
-            (!DisregardTime || (*itr)->JoinTime <= DisregardTime              // pass if disregard time is greater than join time
-             || (*itr)->ArenaTeamRating == 0                 // pass if no rating info
-             || ((*itr)->ArenaTeamRating >= MinRating       // pass if matches the rating range
-                 && (*itr)->ArenaTeamRating <= MaxRating)))
+        for (; itr != waiting.end(); ++itr)
+            if (IsEligibleGroup(*itr, BgTypeId, side, MaxPlayers, ArenaType, IsRated, excludeTeam))
+                push_back(*itr);                        // using push_back for proper selecting when inviting
+        return;
+    }
+
+    // groups that joined before the disregard time match any rating, they are at the front of the list
+    for (; itr != waiting.end() && (*itr)->JoinTime <= DisregardTime; ++itr)
+        if (IsEligibleGroup(*itr, BgTypeId, side, MaxPlayers, ArenaType, IsRated, excludeTeam))
+            push_back(*itr);
+
+    // the later ones only if they have no rating info or one inside the window
+    std::vector<GroupQueueInfo*> inWindow;
+    RatedGroupsIndex const& rated = queue->m_RatedGroups[queue_id];
+    RatedGroupsIndex::const_iterator ritr, rend;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (!pass)
         {
-            // the group matches the conditions
-            // using push_back for proper selecting when inviting
-            push_back((*itr));
+            ritr = rated.lower_bound(0);
+            rend = rated.upper_bound(0);
         }
+        else
+        {
+            if (MaxRating < std::max(MinRating, uint32(1)))
+                break;
+            ritr = rated.lower_bound(std::max(MinRating, uint32(1)));
+            rend = rated.upper_bound(MaxRating);
+        }
+
+        for (; ritr != rend; ++ritr)
+            if (ritr->second->JoinTime > DisregardTime && IsEligibleGroup(ritr->second, BgTypeId, side, MaxPlayers, ArenaType, IsRated, excludeTeam))
+                inWindow.push_back(ritr->second);
     }
+
+    std::sort(inWindow.begin(), inWindow.end(), JoinedBefore);
+    insert(end(), inWindow.begin(), inWindow.end());
 }
 
 // selection pool initialization, used to clean up from prev selection
@@ -145,10 +186,15 @@ GroupQueueInfo* BattlegroundQueue::AddGroup(Player* leader, uint32 BgTypeId, uin
     ginfo->Team                      = leader->GetTeam();
     ginfo->ArenaTeamRating           = arenaRating;
     ginfo->OpponentsTeamRating       = 0;                       //initialize it to 0
+    ginfo->QueueId                   = queue_id;
+    ginfo->JoinSequence              = ++m_JoinSequence;
 
     ginfo->Players.clear();
 
-    m_QueuedGroups[queue_id].push_back(ginfo);
+    ginfo->QueuedItr = m_QueuedGroups[queue_id].insert(m_QueuedGroups[queue_id].end(), ginfo);
+    ginfo->WaitingItr = m_WaitingGroups[queue_id].insert(m_WaitingGroups[queue_id].end(), ginfo);
+    if (isRated)
+        ginfo->RatingItr = m_RatedGroups[queue_id].insert(std::make_pair(arenaRating, ginfo));
 
     // return ginfo, because it is needed to add players to this group info
     return ginfo;
@@ -262,11 +308,8 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
 
     group = itr->second.GroupInfo;
 
-    for (group_itr = m_QueuedGroups[queue_id].begin(); group_itr != m_QueuedGroups[queue_id].end(); ++group_itr)
-    {
-        if (group == (GroupQueueInfo*)(*group_itr))
-            break;
-    }
+    // the group is only found if it was queued in the player's bracket
+    group_itr = group->QueueId == uint32(queue_id) ? group->QueuedItr : m_QueuedGroups[queue_id].end();
 
     // variables are set (what about leveling up when in queue????)
     // remove player from group
@@ -319,6 +362,7 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
         // remove group queue info if needed
         if (group->Players.empty())
         {
+            RemoveFromWaitingGroups(group);
             m_QueuedGroups[queue_id].erase(group_itr);
             delete group;
         }
@@ -355,6 +399,7 @@ bool BattlegroundQueue::InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg,
     {
         // not yet invited
         // set invitation
+        RemoveFromWaitingGroups(ginfo);
         ginfo->IsInvitedToBGInstanceGUID = bg->GetInstanceID();
         uint32 bgQueueTypeId = sBattlegroundMgr.BGQueueTypeId(bg->GetTypeID(), bg->GetArenaType());
         // loop through the players
@@ -442,7 +487,7 @@ bool BattlegroundQueue::BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uin
     }
 
     // initiate the groups eligible to create the bg
-    m_EligibleGroups.Init(&(m_QueuedGroups[queue_id]), bgTypeId, side, MaxPlayers, ArenaType, isRated, MinRating, MaxRating, DisregardTime, excludeTeam);
+    m_EligibleGroups.Init(this, queue_id, bgTypeId, side, MaxPlayers, ArenaType, isRated, MinRating, MaxRating, DisregardTime, excludeTeam);
     // init the selected groups (clear)
     // and set m_CurrEligGroups pointer
     // we set it this way to only have one EligibleGroups object to save some memory
@@ -465,6 +510,17 @@ bool BattlegroundQueue::BuildSelectionPool(uint32 bgTypeId, uint32 queue_id, uin
     return false;
 }
 
+// takes the group out of the matchmaking indexes, when invited or removed from the queue
+void BattlegroundQueue::RemoveFromWaitingGroups(GroupQueueInfo* ginfo)
+{
+    if (ginfo->IsInvitedToBGInstanceGUID)
+        return;
+
+    m_WaitingGroups[ginfo->QueueId].erase(ginfo->WaitingItr);
+    if (ginfo->IsRated)
+        m_RatedGroups[ginfo->QueueId].erase(ginfo->RatingItr);
+}
+
 // used to remove the Enter Battle window if the battle has already, but someone still has it
 // (this can happen in arenas mainly, since the preparation is shorter than the timer for the bgqueueremove event
 void BattlegroundQueue::BGEndedRemoveInvites(Battleground* bg)
@@ -537,8 +593,8 @@ void BattlegroundQueue::Update(uint32 bgTypeId, uint32 queue_id, uint8 arenatype
         return;
     }
 
-    //if no players in queue ... do nothing
-    if (m_QueuedGroups[queue_id].empty())
+    //if no group waits for an invite ... do nothing
+    if (m_WaitingGroups[queue_id].empty())
         return;
 
     //battleground with free slot for player should be always the last in this queue
@@ -555,8 +611,12 @@ void BattlegroundQueue::Update(uint32 bgTypeId, uint32 queue_id, uint8 arenatype
             Battleground* bg = *itr; //we have to store battleground pointer here, because when battleground is full, it is removed from free queue (not yet implemented!!)
             // and iterator is invalid
 
-            for (QueuedGroupsList::iterator itr = m_QueuedGroups[queue_id].begin(); itr != m_QueuedGroups[queue_id].end(); ++itr)
+            // only groups not invited yet, inviting takes the group out of the list
+            QueuedGroupsList::iterator gnext;
+            for (QueuedGroupsList::iterator itr = m_WaitingGroups[queue_id].begin(); itr != m_WaitingGroups[queue_id].end(); itr = gnext)
             {
+                gnext = itr;
+                ++gnext;
                 // did the group join for this bg type?
                 if ((*itr)->BgTypeId != bgTypeId)
                     continue;
@@ -986,6 +1046,7 @@ BattlegroundMgr::BattlegroundMgr()
     m_AutoDistributionTimeChecker = 0;
     m_ArenaTesting = false;
     m_Testing = false;
+    m_WorldThreadKnown = false;
 }
 
 BattlegroundMgr::~BattlegroundMgr()
@@ -1014,12 +1075,21 @@ void BattlegroundMgr::DeleteAlllBattlegrounds()
 // used to update running battlegrounds, and delete finished ones
 void BattlegroundMgr::Update(uint32 diff)
 {
+    PROFILE_ZONE("BattlegroundMgr::Update");
+
+    m_WorldThread = ACE_OS::thr_self();
+    m_WorldThreadKnown = true;
+
+    // Battleground::Update is run by each BattlegroundMap, finish what the maps handed back
+    ProcessTasks();
+
     BattlegroundSet::iterator itr, next;
     for (itr = m_Battlegrounds.begin(); itr != m_Battlegrounds.end(); itr = next)
     {
         next = itr;
         ++next;
-        itr->second->Update(diff);
+        // leaving players update the queues and groups, so they are removed here
+        itr->second->ProcessRemovedPlayers();
         // use the SetDeleteThis variable
         // direct deletion caused crashes
         if (itr->second->m_SetDeleteThis)
@@ -1061,6 +1131,52 @@ void BattlegroundMgr::Update(uint32 diff)
     }
 }
 
+// true in the thread running World::Update, and before it started
+bool BattlegroundMgr::IsInWorldThread() const
+{
+    return !m_WorldThreadKnown || ACE_OS::thr_equal(ACE_OS::thr_self(), m_WorldThread);
+}
+
+void BattlegroundMgr::ScheduleTask(BattlegroundTaskType type, uint32 instanceId)
+{
+    BattlegroundTask task;
+    task.type = type;
+    task.instanceId = instanceId;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_TasksLock);
+    m_Tasks.push_back(task);
+}
+
+void BattlegroundMgr::ProcessTasks()
+{
+    std::vector<BattlegroundTask> tasks;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_TasksLock);
+        tasks.swap(m_Tasks);
+    }
+
+    for (std::vector<BattlegroundTask>::const_iterator itr = tasks.begin(); itr != tasks.end(); ++itr)
+    {
+        // battlegrounds are only deleted below, after their tasks ran
+        Battleground* bg = GetBattleground(itr->instanceId);
+        if (!bg)
+            continue;
+
+        switch (itr->type)
+        {
+            case BG_TASK_ADD_FREE_SLOT:
+                bg->AddToBGFreeSlotQueue();
+                break;
+            case BG_TASK_REMOVE_FREE_SLOT:
+                bg->RemoveFromBGFreeSlotQueue();
+                break;
+            case BG_TASK_REMOVE_INVITES:
+                bg->RemoveQueueInvites();
+                break;
+        }
+    }
+}
+
 void BattlegroundMgr::BuildBattlegroundStatusPacket(WorldPacket* data, Battleground* bg, uint32 /*team*/, uint8 QueueSlot, uint8 StatusID, uint32 Time1, uint32 Time2, uint32 arenatype, uint8 israted)
 {
     // we can be in 3 queues in same time...
@@ -1629,7 +1745,7 @@ void BattlegroundMgr::InitAutomaticArenaPointDistribution()
 void BattlegroundMgr::DistributeArenaPoints()
 {
     // used to distribute arena points based on last week's stats
-    sWorld.SendGlobalText("Flushing Arena points based on team ratings, this may take a few minutes. Please stand by...", NULL);
+    sWorld.SendGlobalText("Flushing Arena points based on team ratings...", NULL);
 
     sWorld.SendGlobalText("Distributing arena points to players...", NULL);
 
@@ -1643,14 +1759,17 @@ void BattlegroundMgr::DistributeArenaPoints()
             at->UpdateArenaPointsHelper(PlayerPoints);
     }
 
-    //cycle that gives points to all players
+    // online players get their points in memory, offline ones are grouped by the amount
+    // so the whole distribution takes a few multi-row updates instead of one per player
+    typedef std::map<uint32, std::vector<uint32> > OfflinePointsMap;
+    OfflinePointsMap OfflinePoints;
     for (std::map<uint32, uint32>::iterator plr_itr = PlayerPoints.begin(); plr_itr != PlayerPoints.end(); ++plr_itr)
     {
         //add points if player is online
         if (Player* player = HashMapHolder<Player>::Find(plr_itr->first))
             player->ModifyArenaPoints(plr_itr->second, true);
-        else
-            CharacterDatabase.PExecute("UPDATE characters SET arenaPoints = arenaPoints + '%u' WHERE guid = '%u'", plr_itr->second, plr_itr->first);
+        else if (plr_itr->second)
+            OfflinePoints[plr_itr->second].push_back(plr_itr->first);
     }
 
     PlayerPoints.clear();
@@ -1663,11 +1782,30 @@ void BattlegroundMgr::DistributeArenaPoints()
         if (ArenaTeam* at = titr->second)
         {
             at->FinishWeek();                              // set played this week etc values to 0 in memory, too
-            at->SaveToDB();                                // save changes
             at->NotifyStatsChanged();                      // notify the players of the changes
         }
     }
 
+    // everything else of the teams is saved after each match, only the weekly counters changed
+    // all of it goes to the database thread as one transaction
+    CharacterDatabase.BeginTransaction();
+    for (OfflinePointsMap::const_iterator points_itr = OfflinePoints.begin(); points_itr != OfflinePoints.end(); ++points_itr)
+    {
+        const std::vector<uint32>& guids = points_itr->second;
+        for (size_t i = 0; i < guids.size();)
+        {
+            std::ostringstream ss;
+            ss << "UPDATE characters SET arenaPoints = arenaPoints + '" << points_itr->first << "' WHERE guid IN (";
+            for (size_t end = std::min(i + ARENA_POINTS_GUIDS_PER_QUERY, guids.size()); i < end; ++i)
+                ss << (i % ARENA_POINTS_GUIDS_PER_QUERY ? "," : "") << guids[i];
+            ss << ")";
+            CharacterDatabase.Execute(ss.str().c_str());
+        }
+    }
+    CharacterDatabase.Execute("UPDATE arena_team_stats SET games = '0', wins = '0'");
+    CharacterDatabase.Execute("UPDATE arena_team_member SET played_week = '0', wons_week = '0'");
+    CharacterDatabase.CommitTransaction();
+
     sWorld.SendGlobalText("Modification done.", NULL);
 
     sWorld.SendGlobalText("Done flushing Arena points.", NULL);
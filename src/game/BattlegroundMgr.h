@@ -21,6 +21,9 @@
 #include "Battleground.h"
 #include "Policies/Singleton.h"
 
+#include <ace/Thread_Mutex.h>
+#include <ace/OS_NS_Thread.h>
+
 class Battleground;
 
 //TODO it is not possible to have this structure, because we should have BattlegroundSet for each queue
@@ -29,6 +32,21 @@ typedef std::map<uint32, Battleground*> BattlegroundSet;
 //typedef std::map<uint32, BattlegroundQueue*> BattlegroundQueueSet;
 typedef std::list<Battleground*> BGFreeSlotQueueType;
 
+// Global bookkeeping a battleground asks for while its map updates it on a map thread,
+// done by BattlegroundMgr::Update on the world thread
+enum BattlegroundTaskType
+{
+    BG_TASK_ADD_FREE_SLOT,                                  // Battleground::AddToBGFreeSlotQueue
+    BG_TASK_REMOVE_FREE_SLOT,                               // Battleground::RemoveFromBGFreeSlotQueue
+    BG_TASK_REMOVE_INVITES                                  // Battleground::RemoveQueueInvites
+};
+
+struct BattlegroundTask
+{
+    BattlegroundTaskType type;
+    uint32 instanceId;
+};
+
 #define MAX_BATTLEGROUND_QUEUES 7                           // for level ranges 10-19, 20-29, 30-39, 40-49, 50-59, 60-69, 70+
 
 #define MAX_BATTLEGROUND_TYPES 9                            // each BG type will be in array
@@ -36,6 +54,7 @@ typedef std::list<Battleground*> BGFreeSlotQueueType;
 #define MAX_BATTLEGROUND_QUEUE_TYPES 8
 
 #define BATTLEGROUND_ARENA_POINT_DISTRIBUTION_DAY    86400     // seconds in a day
+#define ARENA_POINTS_GUIDS_PER_QUERY                 1000      // offline players per arena points update query
 
 struct GroupQueueInfo;                                      // type predefinition
 struct PlayerQueueInfo                                      // stores information for players in queue
@@ -58,6 +77,13 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  IsInvitedToBGInstanceGUID;                      // was invited to certain BG
     uint32  ArenaTeamRating;                                // if rated match, inited to the rating of the team
     uint32  OpponentsTeamRating;                            // for rated arena matches
+
+    // position of the group in the queue indexes, see BattlegroundQueue
+    uint32  QueueId;                                        // level bracket the group was queued in
+    uint32  JoinSequence;                                   // join order, JoinTime can be equal for several groups
+    std::list<GroupQueueInfo*>::iterator QueuedItr;         // in m_QueuedGroups
+    std::list<GroupQueueInfo*>::iterator WaitingItr;        // in m_WaitingGroups, until invited
+    std::multimap<uint32, GroupQueueInfo*>::iterator RatingItr; // in m_RatedGroups, until invited (rated groups only)
 };
 
 class Battleground;
@@ -81,11 +107,18 @@ class BattlegroundQueue
         typedef std::list<GroupQueueInfo*> QueuedGroupsList;
         QueuedGroupsList m_QueuedGroups[MAX_BATTLEGROUND_QUEUES];
 
+        // Matchmaking indexes, updated when a group joins, gets invited or leaves, so queue
+        // updates don't rescan the whole queue: the groups not invited yet in join order,
+        // and the rated ones among them by team rating.
+        QueuedGroupsList m_WaitingGroups[MAX_BATTLEGROUND_QUEUES];
+        typedef std::multimap<uint32, GroupQueueInfo*> RatedGroupsIndex;
+        RatedGroupsIndex m_RatedGroups[MAX_BATTLEGROUND_QUEUES];
+
         // class to hold pointers to the groups eligible for a specific selection pool building mode
         class EligibleGroups : public std::list<GroupQueueInfo*>
         {
             public:
-                void Init(QueuedGroupsList* source, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType = 0, bool IsRated = false, uint32 MinRating = 0, uint32 MaxRating = 0, uint32 DisregardTime = 0, uint32 excludeTeam = 0);
+                void Init(BattlegroundQueue* queue, uint32 queue_id, uint32 BgTypeId, uint32 side, uint32 MaxPlayers, uint8 ArenaType = 0, bool IsRated = false, uint32 MinRating = 0, uint32 MaxRating = 0, uint32 DisregardTime = 0, uint32 excludeTeam = 0);
         };
 
         EligibleGroups m_EligibleGroups;
@@ -128,6 +161,9 @@ class BattlegroundQueue
     private:
 
         bool InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg, uint32 side);
+        void RemoveFromWaitingGroups(GroupQueueInfo* ginfo);
+
+        uint32 m_JoinSequence;
 };
 
 /*
@@ -264,7 +300,17 @@ class BattlegroundMgr
         }
 
         void SetHolidayWeekends(uint32 mask);
+
+        /* Map thread hand off */
+        bool IsInWorldThread() const;
+        void ScheduleTask(BattlegroundTaskType type, uint32 instanceId);
     private:
+        void ProcessTasks();
+
+        std::vector<BattlegroundTask> m_Tasks;
+        ACE_Thread_Mutex m_TasksLock;
+        ACE_thread_t m_WorldThread;
+        bool m_WorldThreadKnown;
 
         /* Battlegrounds */
         BattlegroundSet m_Battlegrounds;
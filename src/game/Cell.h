@@ -26,6 +26,10 @@
 class Map;
 class WorldObject;
 
+// extra distance around a search circle in which cells are still visited,
+// covers the size of objects standing just outside the searched radius
+#define CELL_VISIT_SIZE_MARGIN  10.0f
+
 struct CellArea
 {
     CellArea() { }
@@ -108,6 +112,7 @@ struct Cell
     template<class T, class CONTAINER> void Visit(CellCoord const&, TypeContainerVisitor<T, CONTAINER>& visitor, Map &, float, float, float) const;
 
     static CellArea CalculateCellArea(float x, float y, float radius);
+    static bool IsCellInRange(CellCoord const& p, float x, float y, float radius);
 
 private:
     template<class T, class CONTAINER> void VisitCircle(TypeContainerVisitor<T, CONTAINER> &, Map &, CellCoord const&, CellCoord const&) const;
@@ -59,6 +59,18 @@ inline CellArea Cell::CalculateCellArea(float x, float y, float radius)
     return CellArea(centerX, centerY);
 }
 
+inline bool Cell::IsCellInRange(CellCoord const& p, float x, float y, float radius)
+{
+    // cell p covers [(p - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL, +SIZE_OF_GRID_CELL) on both axes,
+    // objects are matched including their own size so keep a margin for big ones
+    float low_x = (float(p.x_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float low_y = (float(p.y_coord) - CENTER_GRID_CELL_ID) * SIZE_OF_GRID_CELL;
+    float dx = std::max(std::max(low_x - x, x - (low_x + SIZE_OF_GRID_CELL)), 0.0f);
+    float dy = std::max(std::max(low_y - y, y - (low_y + SIZE_OF_GRID_CELL)), 0.0f);
+    float range = radius + CELL_VISIT_SIZE_MARGIN;
+    return dx * dx + dy * dy <= range * range;
+}
+
 template<class T, class CONTAINER>
 inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T, CONTAINER>& visitor, Map& map, float radius, float x_off, float y_off) const
 {
@@ -107,7 +119,8 @@ inline void Cell::Visit(CellCoord const& standing_cell, TypeContainerVisitor<T,
         {
             CellCoord cellCoord(x, y);
             //lets skip standing cell since we already visited it
-            if (cellCoord != standing_cell)
+            //and corner cells of the area that the search circle doesn't reach
+            if (cellCoord != standing_cell && IsCellInRange(cellCoord, x_off, y_off, radius))
             {
                 Cell r_zone(cellCoord);
                 r_zone.data.Part.nocreate = this->data.Part.nocreate;
@@ -626,6 +626,8 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
             SendPacket(&data);
             DEBUG_LOG("WORLD: Sent guild-motd (SMSG_GUILD_EVENT)");
 
+            guild->SetMemberOnline(pCurrChar);
+
             data.Initialize(SMSG_GUILD_EVENT, (5 + 10));    // we guess size
             data << (uint8)GE_SIGNED_ON;
             data << (uint8)1;
@@ -34,6 +34,7 @@
 #include "SpellMgr.h"
 
 bool ChatHandler::load_command_table = true;
+ChatHandler::ChatCommandIndexMap ChatHandler::m_commandIndex;
 
 ChatCommand* ChatHandler::getCommandTable()
 {
@@ -65,6 +66,13 @@ ChatCommand* ChatHandler::getCommandTable()
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
+    static ChatCommand serverProfileCommandTable[] =
+    {
+        { "start",          SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerProfileStartCommand,  "", NULL },
+        { "stop",           SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerProfileStopCommand,   "", NULL },
+        { NULL,             0,                  false, NULL,                                           "", NULL }
+    };
+
     static ChatCommand serverIdleRestartCommandTable[] =
     {
         { "cancel",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerShutDownCancelCommand, "", NULL },
@@ -102,9 +110,11 @@ ChatCommand* ChatHandler::getCommandTable()
         { "info",           SEC_PLAYER,         true,  &ChatHandler::HandleServerInfoCommand,          "", NULL },
         { "motd",           SEC_PLAYER,         true,  &ChatHandler::HandleServerMotdCommand,          "", NULL },
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", NULL },
+        { "profile",        SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverProfileCommandTable },
         { "restart",        SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverRestartCommandTable },
         { "shutdown",       SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverShutdownCommandTable },
         { "set",            SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverSetCommandTable },
+        { "throttle",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerThrottleCommand,      "", NULL },
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
@@ -246,6 +256,7 @@ ChatCommand* ChatHandler::getCommandTable()
         { "spellcrashtest", SEC_ADMINISTRATOR,  false, &ChatHandler::HandleSpellCrashTestCommand,      "", NULL },
         { "partyresult",    SEC_ADMINISTRATOR,  false, &ChatHandler::HandlePartyResultCommand,         "", NULL },
         { "animate",        SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugAnimationCommand,      "", NULL },
+        { "relocation",     SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugRelocationCommand,     "", NULL },
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
@@ -864,6 +875,48 @@ void ChatHandler::PSendSysMessage(const char* format, ...)
     SendSysMessage(str);
 }
 
+// positions of the table entries the typed command can match, in table order like the old linear walk
+void ChatHandler::GetCommandCandidates(ChatCommand* table, const std::string& cmd, std::vector<uint32>& positions)
+{
+    ChatCommandIndexMap::iterator itr = m_commandIndex.find(table);
+    if (itr == m_commandIndex.end())
+    {
+        // names never change, so each table is indexed once
+        ChatCommandIndex& index = m_commandIndex[table];
+        for (uint32 i = 0; table[i].Name != NULL; ++i)
+        {
+            if (!*table[i].Name)
+            {
+                index.AnyName.push_back(i);
+                continue;
+            }
+
+            std::string name = table[i].Name;
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            index.Names.push_back(std::make_pair(name, i));
+        }
+        std::sort(index.Names.begin(), index.Names.end());
+
+        itr = m_commandIndex.find(table);
+    }
+
+    ChatCommandIndex const& index = itr->second;
+
+    // "" part only matches "" named entries, see hasStringAbbr
+    if (!cmd.empty())
+    {
+        std::string part = cmd;
+        std::transform(part.begin(), part.end(), part.begin(), ::tolower);
+
+        std::vector<std::pair<std::string, uint32> >::const_iterator name = std::lower_bound(index.Names.begin(), index.Names.end(), std::make_pair(part, uint32(0)));
+        for (; name != index.Names.end() && !name->first.compare(0, part.size(), part); ++name)
+            positions.push_back(name->second);
+    }
+
+    positions.insert(positions.end(), index.AnyName.begin(), index.AnyName.end());
+    std::sort(positions.begin(), positions.end());
+}
+
 bool ChatHandler::ExecuteCommandInTable(ChatCommand* table, const char* text, const std::string& fullcmd)
 {
     char const* oldtext = text;
@@ -877,10 +930,12 @@ bool ChatHandler::ExecuteCommandInTable(ChatCommand* table, const char* text, co
 
     while (*text == ' ') ++text;
 
-    for (uint32 i = 0; table[i].Name != NULL; ++i)
+    std::vector<uint32> candidates;
+    GetCommandCandidates(table, cmd, candidates);
+
+    for (std::vector<uint32>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
     {
-        if (!hasStringAbbr(table[i].Name, cmd.c_str()))
-            continue;
+        uint32 i = *itr;
 
         // select subcommand from child commands list
         if (table[i].ChildCommands != NULL)
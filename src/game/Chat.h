@@ -39,6 +39,13 @@ class ChatCommand
         ChatCommand*       ChildCommands;
 };
 
+// entries of one command table sorted by name, so the entries an abbreviation can match are found without walking the table
+struct ChatCommandIndex
+{
+    std::vector<std::pair<std::string, uint32> > Names;     // lowercase name, position in the table
+    std::vector<uint32> AnyName;                            // positions of "" named entries, they match everything
+};
+
 class ChatHandler
 {
     public:
@@ -99,6 +106,7 @@ class ChatHandler
         void SendGlobalGMSysMessage(const char* str);
 
         bool ExecuteCommandInTable(ChatCommand* table, const char* text, const std::string& fullcommand);
+        static void GetCommandCandidates(ChatCommand* table, const std::string& cmd, std::vector<uint32>& positions);
         bool ShowHelpForCommand(ChatCommand* table, const char* cmd);
         bool ShowHelpForSubCommands(ChatCommand* table, char const* cmd, char const* subcmd);
 
@@ -325,12 +333,15 @@ class ChatHandler
         bool HandleServerInfoCommand(const char* args);
         bool HandleServerMotdCommand(const char* args);
         bool HandleServerPLimitCommand(const char* args);
+        bool HandleServerProfileStartCommand(const char* args);
+        bool HandleServerProfileStopCommand(const char* args);
         bool HandleServerRestartCommand(const char* args);
         bool HandleServerSetLogMaskCommand(const char* args);
         bool HandleServerSetMotdCommand(const char* args);
         bool HandleServerSetDiffTimeCommand(const char* args);
         bool HandleServerShutDownCommand(const char* args);
         bool HandleServerShutDownCancelCommand(const char* args);
+        bool HandleServerThrottleCommand(const char* args);
 
         bool HandleAddHonorCommand(const char* args);
         bool HandleHonorAddKillCommand(const char* args);
@@ -550,6 +561,7 @@ class ChatHandler
         bool HandleSpellCrashTestCommand(const char* args);
         bool HandlePartyResultCommand(const char* args);
         bool HandleDebugAnimationCommand(const char* args);
+        bool HandleDebugRelocationCommand(const char* args);
 
         Player*   getSelectedPlayer();
         Player*   getSelectedPlayerOrSelf();
@@ -598,6 +610,9 @@ class ChatHandler
 
         // common global flag
         static bool load_command_table;
+
+        typedef std::map<ChatCommand const*, ChatCommandIndex> ChatCommandIndexMap;
+        static ChatCommandIndexMap m_commandIndex;
         bool sentErrorMessage;
 };
 
@@ -44,6 +44,7 @@
 #include "GameEventMgr.h"
 #include "CreatureGroups.h"
 #include "MoveSpline.h"
+#include "TickProfiler.h"
 
 void TrainerSpellData::Clear()
 {
@@ -466,6 +467,8 @@ bool Creature::UpdateEntry(uint32 Entry, uint32 team, const CreatureData* data)
 
 void Creature::Update(uint32 diff)
 {
+    PROFILE_ZONE("Creature::Update");
+
     if (m_GlobalCooldown <= diff)
         m_GlobalCooldown = 0;
     else
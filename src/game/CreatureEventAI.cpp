@@ -57,39 +57,18 @@ int CreatureEventAI::Permissible(const Creature* creature)
 
 CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c)
 {
-    hasLosEvents = false;
+    EventAI_ProgramVariant variant = EVENTAI_VARIANT_WORLD;
+    if (me->GetMap()->IsDungeon())
+        variant = me->GetMap()->IsHeroic() ? EVENTAI_VARIANT_HEROIC : EVENTAI_VARIANT_NORMAL;
 
-    // Need make copy for filter unneeded steps and safe in case table reload
-    CreatureEventAI_Event_Map::const_iterator CreatureEvents = CreatureEAI_Mgr.GetCreatureEventAIMap().find(me->GetEntry());
-    if (CreatureEvents != CreatureEAI_Mgr.GetCreatureEventAIMap().end())
+    // Events are shared with all creatures of the entry, only their timers are kept here
+    Program = CreatureEAI_Mgr.GetProgram(me->GetEntry(), variant);
+    if (Program.get())
     {
-        std::vector<CreatureEventAI_Event>::const_iterator i;
-        for (i = (*CreatureEvents).second.begin(); i != (*CreatureEvents).second.end(); ++i)
-        {
-
-            //Debug check
-            #ifndef OREGON_DEBUG
-            if ((*i).event_flags & EFLAG_DEBUG_ONLY)
-                continue;
-            #endif
-            if (((*i).event_flags & (EFLAG_HEROIC | EFLAG_NORMAL)) && me->GetMap()->IsDungeon())
-            {
-                if ((me->GetMap()->IsHeroic() && (*i).event_flags & EFLAG_HEROIC) ||
-                    (!me->GetMap()->IsHeroic() && (*i).event_flags & EFLAG_NORMAL))
-                {
-                    //event flagged for instance mode
-                    CreatureEventAIList.push_back(CreatureEventAIHolder(*i));
-
-                    if ((*i).event_type == EVENT_T_OOC_LOS)
-                        hasLosEvents = true;
-                }
-                continue;
-            }
+        CreatureEventAIList.reserve(Program->events.size());
+        for (std::vector<CreatureEventAI_Event>::const_iterator i = Program->events.begin(); i != Program->events.end(); ++i)
             CreatureEventAIList.push_back(CreatureEventAIHolder(*i));
 
-            if ((*i).event_type == EVENT_T_OOC_LOS)
-                hasLosEvents = true;
-        }
         //EventMap had events but they were not added because they must be for instance
         if (CreatureEventAIList.empty())
             sLog.outError("CreatureEventAI: Creature %u has events but no events added to list because of instance flags.", me->GetEntry());
@@ -98,6 +77,7 @@ CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c)
         sLog.outError("CreatureEventAI: EventMap for Creature %u is empty but creature is using CreatureEventAI.", me->GetEntry());
 
     bEmptyList = CreatureEventAIList.empty();
+    hasLosEvents = !bEmptyList && Program->FirstOfType(EVENT_T_OOC_LOS) != Program->EndOfType(EVENT_T_OOC_LOS);
     Phase = 0;
     MeleeEnabled = true;
 
@@ -106,12 +86,21 @@ CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c)
     //Handle Spawned Events
     if (!bEmptyList)
     {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-            if (SpawnedEventConditionsCheck((*i).Event))
-                ProcessEvent(*i);
+        for (uint32 i = Program->FirstOfType(EVENT_T_SPAWNED); i < Program->EndOfType(EVENT_T_SPAWNED); ++i)
+            if (SpawnedEventConditionsCheck(CreatureEventAIList[i].Event))
+                ProcessEvent(CreatureEventAIList[i]);
     }
 }
 
+void CreatureEventAI::ProcessEventsOfType(EventAI_Type type, Unit* pActionInvoker)
+{
+    if (bEmptyList)
+        return;
+
+    for (uint32 i = Program->FirstOfType(type); i < Program->EndOfType(type); ++i)
+        ProcessEvent(CreatureEventAIList[i], pActionInvoker);
+}
+
 bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker)
 {
     if (!pHolder.Enabled || pHolder.Time)
@@ -395,6 +384,13 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
     if (!(pHolder.Event.event_flags & EFLAG_REPEATABLE))
         pHolder.Enabled = false;
 
+    //UpdateAI only visits hook driven events while their repeat timer runs
+    if (pHolder.Time && !pHolder.Cooling && !IsEventAIUpdateEvent(pHolder.Event.event_type))
+    {
+        pHolder.Cooling = true;
+        CoolingEvents.push_back(uint16(&pHolder - &CreatureEventAIList[0]));
+    }
+
     //Store random here so that all random actions match up
     uint32 rnd = rand();
 
@@ -877,9 +873,9 @@ void CreatureEventAI::JustRespawned()
         return;
 
     //Handle Spawned Events
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        if (SpawnedEventConditionsCheck((*i).Event))
-            ProcessEvent(*i);
+    for (uint32 i = Program->FirstOfType(EVENT_T_SPAWNED); i < Program->EndOfType(EVENT_T_SPAWNED); ++i)
+        if (SpawnedEventConditionsCheck(CreatureEventAIList[i].Event))
+            ProcessEvent(CreatureEventAIList[i]);
 }
 
 void CreatureEventAI::Reset()
@@ -890,38 +886,19 @@ void CreatureEventAI::Reset()
     if (bEmptyList)
         return;
 
-    //Reset all events to enabled
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+    //Reset all out of combat timers
+    //@todo verify if all other events previously disabled (ex. aggro yell) should be enabled here, instead of in void EnterCombat()
+    for (uint32 i = Program->FirstOfType(EVENT_T_TIMER_OOC); i < Program->EndOfType(EVENT_T_TIMER_OOC); ++i)
     {
-        CreatureEventAI_Event const& event = (*i).Event;
-        switch (event.event_type)
-        {
-        //Reset all out of combat timers
-        case EVENT_T_TIMER_OOC:
-            {
-                if ((*i).UpdateRepeatTimer(me, event.timer.initialMin, event.timer.initialMax))
-                    (*i).Enabled = true;
-                break;
-            }
-            //default:
-            //@todo enable below code line / verify this is correct to enable events previously disabled (ex. aggro yell), instead of enable this in void EnterCombat()
-            //(*i).Enabled = true;
-            //(*i).Time = 0;
-            //break;
-        }
+        CreatureEventAIHolder& holder = CreatureEventAIList[i];
+        if (holder.UpdateRepeatTimer(me, holder.Event.timer.initialMin, holder.Event.timer.initialMax))
+            holder.Enabled = true;
     }
 }
 
 void CreatureEventAI::JustReachedHome()
 {
-    if (!bEmptyList)
-    {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        {
-            if ((*i).Event.event_type == EVENT_T_REACHED_HOME)
-                ProcessEvent(*i);
-        }
-    }
+    ProcessEventsOfType(EVENT_T_REACHED_HOME);
 
     Reset();
 }
@@ -930,15 +907,8 @@ void CreatureEventAI::EnterEvadeMode()
 {
     CreatureAI::EnterEvadeMode();
 
-    if (bEmptyList)
-        return;
-
     //Handle Evade events
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_EVADE)
-            ProcessEvent(*i);
-    }
+    ProcessEventsOfType(EVENT_T_EVADE);
 }
 
 void CreatureEventAI::JustDied(Unit* killer)
@@ -952,19 +922,17 @@ void CreatureEventAI::JustDied(Unit* killer)
 
 	std::list<Creature*> pList;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+    for (uint32 i = Program->FirstOfType(EVENT_T_DEATH); i < Program->EndOfType(EVENT_T_DEATH); ++i)
     {
-		if ((*i).Event.event_type == EVENT_T_DEATH)
-		{
-			DoFindFriendlyNPConDeath(pList, (*i).Event.death.targetguid, (*i).Event.death.radius, (*i).Event.death.myguid);
+		CreatureEventAIHolder& holder = CreatureEventAIList[i];
+		DoFindFriendlyNPConDeath(pList, holder.Event.death.targetguid, holder.Event.death.radius, holder.Event.death.myguid);
 
-			if (pList.empty())
-				Invoker = NULL;
-			else
-				Invoker = *(pList.begin());
+		if (pList.empty())
+			Invoker = NULL;
+		else
+			Invoker = *(pList.begin());
 
-			ProcessEvent(*i, Invoker);
-		}
+		ProcessEvent(holder, Invoker);
     }
 
     Phase = 0;
@@ -972,26 +940,18 @@ void CreatureEventAI::JustDied(Unit* killer)
 
 void CreatureEventAI::KilledUnit(Unit* victim)
 {
-    if (bEmptyList || victim->GetTypeId() != TYPEID_PLAYER)
+    if (victim->GetTypeId() != TYPEID_PLAYER)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_KILL)
-            ProcessEvent(*i, victim);
-    }
+    ProcessEventsOfType(EVENT_T_KILL, victim);
 }
 
 void CreatureEventAI::JustSummoned(Creature* pUnit)
 {
-    if (bEmptyList || !pUnit)
+    if (!pUnit)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_UNIT)
-            ProcessEvent(*i, pUnit);
-    }
+    ProcessEventsOfType(EVENT_T_SUMMONED_UNIT, pUnit);
 }
 
 void CreatureEventAI::EnterCombat(Unit* enemy)
@@ -1000,7 +960,7 @@ void CreatureEventAI::EnterCombat(Unit* enemy)
     //Check for on combat start events
     if (!bEmptyList)
     {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+        for (std::vector<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
         {
             CreatureEventAI_Event const& event = (*i).Event;
             switch (event.event_type)
@@ -1058,26 +1018,24 @@ void CreatureEventAI::MoveInLineOfSight(Unit* who)
         if (me->GetVictim())
             return;
 
-        for (std::list<CreatureEventAIHolder>::iterator itr = CreatureEventAIList.begin(); itr != CreatureEventAIList.end(); ++itr)
+        bool isHostile = me->IsHostileTo(who);
+
+        for (uint32 i = Program->FirstOfType(EVENT_T_OOC_LOS); i < Program->EndOfType(EVENT_T_OOC_LOS); ++i)
         {
-            CreatureEventAI_Event aiEvent = (*itr).Event;
+            CreatureEventAIHolder& holder = CreatureEventAIList[i];
+            CreatureEventAI_Event const& aiEvent = holder.Event;
 
-            if (aiEvent.event_type == EVENT_T_OOC_LOS)
+            //if friendly event && who is not hostile OR hostile event && who is hostile
+            if ((aiEvent.ooc_los.noHostile && !isHostile) ||
+                (!aiEvent.ooc_los.noHostile && isHostile))
             {
-                bool isHostile = me->IsHostileTo(who);
+                //can trigger if closer than fMaxAllowedRange
+                float fMaxAllowedRange = aiEvent.ooc_los.maxRange;
 
-                //if friendly event && who is not hostile OR hostile event && who is hostile
-                if ((aiEvent.ooc_los.noHostile && !isHostile) ||
-                    (!aiEvent.ooc_los.noHostile && isHostile))
+                //if range is ok and we are actually in LOS
+                if (me->IsWithinDistInMap(who, fMaxAllowedRange) && me->IsWithinLOSInMap(who))
                 {
-                    //can trigger if closer than fMaxAllowedRange
-                    float fMaxAllowedRange = aiEvent.ooc_los.maxRange;
-
-                    //if range is ok and we are actually in LOS
-                    if (me->IsWithinDistInMap(who, fMaxAllowedRange) && me->IsWithinLOSInMap(who))
-                    {
-                        ProcessEvent(*itr, who);
-                    }
+                    ProcessEvent(holder, who);
                 }
             }
         }
@@ -1092,12 +1050,14 @@ void CreatureEventAI::SpellHit(Unit* pUnit, const SpellEntry* pSpell)
     if (bEmptyList)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        if ((*i).Event.event_type == EVENT_T_SPELLHIT)
-            //If spell id matches (or no spell id) & if spell school matches (or no spell school)
-            if (!(*i).Event.spell_hit.spellId || pSpell->Id == (*i).Event.spell_hit.spellId)
-                if (pSpell->SchoolMask & (*i).Event.spell_hit.schoolMask)
-                    ProcessEvent(*i, pUnit);
+    for (uint32 i = Program->FirstOfType(EVENT_T_SPELLHIT); i < Program->EndOfType(EVENT_T_SPELLHIT); ++i)
+    {
+        CreatureEventAIHolder& holder = CreatureEventAIList[i];
+        //If spell id matches (or no spell id) & if spell school matches (or no spell school)
+        if (!holder.Event.spell_hit.spellId || pSpell->Id == holder.Event.spell_hit.spellId)
+            if (pSpell->SchoolMask & holder.Event.spell_hit.schoolMask)
+                ProcessEvent(holder, pUnit);
+    }
 }
 
 void CreatureEventAI::UpdateAI(const uint32 diff)
@@ -1112,35 +1072,60 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
         {
             EventDiff += diff;
 
+            //Count down the repeat timers of hook driven events, they have nothing to check here
+            for (uint32 i = 0; i < CoolingEvents.size();)
+            {
+                CreatureEventAIHolder& holder = CreatureEventAIList[CoolingEvents[i]];
+                if (EventDiff <= holder.Time)
+                {
+                    //Do not decrement timers if event cannot trigger in this phase
+                    if (!(holder.Event.event_inverse_phase_mask & (1 << Phase)))
+                        holder.Time -= EventDiff;
+                }
+                else holder.Time = 0;
+
+                if (holder.Time)
+                {
+                    ++i;
+                    continue;
+                }
+
+                holder.Cooling = false;
+                CoolingEvents[i] = CoolingEvents.back();
+                CoolingEvents.pop_back();
+            }
+
             //Check for time based events
-            for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+            for (std::vector<uint16>::const_iterator itr = Program->updateEvents.begin(); itr != Program->updateEvents.end(); ++itr)
             {
+                CreatureEventAIHolder& holder = CreatureEventAIList[*itr];
+
                 //Decrement Timers
-                if ((*i).Time)
+                if (holder.Time)
                 {
-                    if (EventDiff <= (*i).Time)
+                    if (EventDiff <= holder.Time)
                     {
                         //Do not decrement timers if event cannot trigger in this phase
-                        if (!((*i).Event.event_inverse_phase_mask & (1 << Phase)))
-                            (*i).Time -= EventDiff;
+                        if (!(holder.Event.event_inverse_phase_mask & (1 << Phase)))
+                            holder.Time -= EventDiff;
 
                         //Skip processing of events that have time remaining
                         continue;
                     }
-                    else (*i).Time = 0;
+                    else holder.Time = 0;
                 }
 
                 //Events that are updated every EVENT_UPDATE_TIME
-                switch ((*i).Event.event_type)
+                switch (holder.Event.event_type)
                 {
                 case EVENT_T_TIMER_OOC:
-                    ProcessEvent(*i);
+                    ProcessEvent(holder);
                     break;
 				case EVENT_T_FRIENDLY_NPC:
-					ProcessEvent(*i);
+					ProcessEvent(holder);
 					break;
 				case EVENT_T_FRIENDLY_NPC_COMBAT:
-					ProcessEvent(*i);
+					ProcessEvent(holder);
 					break;
                 case EVENT_T_TIMER:
                 case EVENT_T_MANA:
@@ -1149,13 +1134,15 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
                 case EVENT_T_TARGET_CASTING:
                 case EVENT_T_FRIENDLY_HP:
                     if (me->GetVictim())
-                        ProcessEvent(*i);
+                        ProcessEvent(holder);
                     break;
                 case EVENT_T_RANGE:
                     if (me->GetVictim())
                         if (me->IsInMap(me->GetVictim()))
-                            if (me->IsInRange(me->GetVictim(), (float)(*i).Event.range.minDist, (float)(*i).Event.range.maxDist))
-                                ProcessEvent(*i);
+                            if (me->IsInRange(me->GetVictim(), (float)holder.Event.range.minDist, (float)holder.Event.range.maxDist))
+                                ProcessEvent(holder);
+                    break;
+                default:
                     break;
                 }
             }
@@ -1473,27 +1460,25 @@ void CreatureEventAI::ReceiveEmote(Player* pPlayer, uint32 text_emote)
     if (bEmptyList)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator itr = CreatureEventAIList.begin(); itr != CreatureEventAIList.end(); ++itr)
+    for (uint32 i = Program->FirstOfType(EVENT_T_RECEIVE_EMOTE); i < Program->EndOfType(EVENT_T_RECEIVE_EMOTE); ++i)
     {
-        if ((*itr).Event.event_type == EVENT_T_RECEIVE_EMOTE)
-        {
-            if ((*itr).Event.receive_emote.emoteId != text_emote)
-                return;
+        CreatureEventAIHolder& holder = CreatureEventAIList[i];
+        if (holder.Event.receive_emote.emoteId != text_emote)
+            return;
 
 
 
-            Condition* cond = new Condition();
-            cond->Type = ConditionType((*itr).Event.receive_emote.condition);            
-            cond->ConditionValue1 = (*itr).Event.receive_emote.conditionValue1;
-            cond->ConditionValue2 = (*itr).Event.receive_emote.conditionValue2;
+        Condition* cond = new Condition();
+        cond->Type = ConditionType(holder.Event.receive_emote.condition);            
+        cond->ConditionValue1 = holder.Event.receive_emote.conditionValue1;
+        cond->ConditionValue2 = holder.Event.receive_emote.conditionValue2;
 
-            ConditionSourceInfo info(pPlayer);
+        ConditionSourceInfo info(pPlayer);
 
-            if (cond->Meets(info))
-            {
-                sLog.outDebug("CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
-                ProcessEvent(*itr, pPlayer);
-            }
+        if (cond->Meets(info))
+        {
+            sLog.outDebug("CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
+            ProcessEvent(holder, pPlayer);
         }
     }
 }
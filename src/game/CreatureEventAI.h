@@ -23,6 +23,9 @@
 #include "CreatureAI.h"
 #include "Unit.h"
 
+#include <ace/Refcounted_Auto_Ptr.h>
+#include <ace/Thread_Mutex.h>
+
 class Player;
 class WorldObject;
 
@@ -580,6 +583,50 @@ struct CreatureEventAI_Event
 //Event_Map
 typedef UNORDERED_MAP<uint32, std::vector<CreatureEventAI_Event> > CreatureEventAI_Event_Map;
 
+// Events checked every EVENT_UPDATE_TIME by UpdateAI, all other types only run from their hooks
+inline bool IsEventAIUpdateEvent(uint32 type)
+{
+    switch (type)
+    {
+        case EVENT_T_TIMER:
+        case EVENT_T_TIMER_OOC:
+        case EVENT_T_HP:
+        case EVENT_T_MANA:
+        case EVENT_T_RANGE:
+        case EVENT_T_TARGET_HP:
+        case EVENT_T_TARGET_CASTING:
+        case EVENT_T_FRIENDLY_HP:
+        case EVENT_T_FRIENDLY_NPC:
+        case EVENT_T_FRIENDLY_NPC_COMBAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+enum EventAI_ProgramVariant
+{
+    EVENTAI_VARIANT_WORLD   = 0,                            // outside of instances, difficulty flags are ignored
+    EVENTAI_VARIANT_NORMAL  = 1,
+    EVENTAI_VARIANT_HEROIC  = 2,
+    MAX_EVENTAI_VARIANTS
+};
+
+// Events of one creature entry for one variant, built at load and shared by every creature of
+// the entry. Events are grouped by type and keep their load order inside a type.
+struct CreatureEventAI_Program
+{
+    std::vector<CreatureEventAI_Event> events;
+    uint16 typeOffset[EVENT_T_END + 1];                     // events of type t are [typeOffset[t], typeOffset[t + 1])
+    std::vector<uint16> updateEvents;                       // indexes of the IsEventAIUpdateEvent types, in load order
+
+    uint32 FirstOfType(EventAI_Type type) const { return typeOffset[type]; }
+    uint32 EndOfType(EventAI_Type type) const { return typeOffset[type + 1]; }
+};
+
+// creatures keep their program alive, a table reload only replaces the manager's copy
+typedef ACE_Refcounted_Auto_Ptr<CreatureEventAI_Program, ACE_Thread_Mutex> CreatureEventAI_ProgramPtr;
+
 struct CreatureEventAI_Summon
 {
     uint32 id;
@@ -594,13 +641,15 @@ struct CreatureEventAI_Summon
 //EventSummon_Map
 typedef UNORDERED_MAP<uint32, CreatureEventAI_Summon> CreatureEventAI_Summon_Map;
 
+// per creature state of one program event
 struct CreatureEventAIHolder
 {
-    CreatureEventAIHolder(CreatureEventAI_Event p) : Event(p), Time(0), Enabled(true) {}
+    CreatureEventAIHolder(CreatureEventAI_Event const& p) : Event(p), Time(0), Enabled(true), Cooling(false) {}
 
-    CreatureEventAI_Event Event;
+    CreatureEventAI_Event const& Event;
     uint32 Time;
     bool Enabled;
+    bool Cooling;                                           // in CoolingEvents, for events not updated every EVENT_UPDATE_TIME
 
     // helper
     bool UpdateRepeatTimer(Creature* creature, uint32 repeatMin, uint32 repeatMax);
@@ -649,8 +698,12 @@ class CreatureEventAI : public CreatureAI
 		void DoFindFriendlyNPCinCombat(std::list<Creature*>& _list, uint64 guid, float range, uint64 myguid, uint32 cooldown);
 		void DoFindFriendlyNPConDeath(std::list<Creature*>& _list, uint64 guid, float range, uint64 myguid);
 
-        //Holder for events (stores enabled, time, and eventid)
-        std::list<CreatureEventAIHolder> CreatureEventAIList;
+        void ProcessEventsOfType(EventAI_Type type, Unit* pActionInvoker = NULL);
+
+        //Shared events of the creature and their state (stores enabled and time), same order as Program->events
+        CreatureEventAI_ProgramPtr Program;
+        std::vector<CreatureEventAIHolder> CreatureEventAIList;
+        std::vector<uint16> CoolingEvents;                  // hook driven events with a repeat timer running
         uint32 EventUpdateTime;                             //Time between event updates
         uint32 EventDiff;                                   //Time between the last event call
         bool bEmptyList;
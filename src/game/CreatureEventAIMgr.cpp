@@ -832,9 +832,93 @@ void CreatureEventAIMgr::LoadCreatureEventAI_Scripts()
         CheckUnusedAITexts();
         CheckUnusedAISummons();
 
+        CompilePrograms();
+
         sLog.outString(">> Loaded %u CreatureEventAI scripts", Count);
     }
     else
+    {
+        m_CreatureEventAI_Program_Map.clear();
         sLog.outString(">> Loaded 0 CreatureEventAI scripts. DB table creature_ai_scripts is empty.");
+    }
+}
+
+// Builds the shared programs from the loaded events. Creatures spawned before a reload keep
+// using the programs they already hold.
+void CreatureEventAIMgr::CompilePrograms()
+{
+    m_CreatureEventAI_Program_Map.clear();
+
+    for (CreatureEventAI_Event_Map::const_iterator itr = m_CreatureEventAI_Event_Map.begin(); itr != m_CreatureEventAI_Event_Map.end(); ++itr)
+    {
+        std::vector<CreatureEventAI_Event> const& events = itr->second;
+
+        bool hasModeEvents = false;
+        for (std::vector<CreatureEventAI_Event>::const_iterator i = events.begin(); i != events.end(); ++i)
+            if (i->event_flags & (EFLAG_HEROIC | EFLAG_NORMAL))
+                hasModeEvents = true;
+
+        CreatureEventAI_ProgramVariants& variants = m_CreatureEventAI_Program_Map[itr->first];
+        for (uint32 variant = 0; variant < MAX_EVENTAI_VARIANTS; ++variant)
+        {
+            // without instance mode flags all variants are the same
+            if (variant && !hasModeEvents)
+            {
+                variants.variant[variant] = variants.variant[EVENTAI_VARIANT_WORLD];
+                continue;
+            }
+
+            std::vector<CreatureEventAI_Event const*> filtered;
+            for (std::vector<CreatureEventAI_Event>::const_iterator i = events.begin(); i != events.end(); ++i)
+            {
+                //Debug check
+                #ifndef OREGON_DEBUG
+                if (i->event_flags & EFLAG_DEBUG_ONLY)
+                    continue;
+                #endif
+
+                //event flagged for instance mode, only used in that mode of dungeons
+                if ((i->event_flags & (EFLAG_HEROIC | EFLAG_NORMAL)) && variant != EVENTAI_VARIANT_WORLD)
+                {
+                    if (!(i->event_flags & (variant == EVENTAI_VARIANT_HEROIC ? EFLAG_HEROIC : EFLAG_NORMAL)))
+                        continue;
+                }
+
+                filtered.push_back(&*i);
+            }
+
+            CreatureEventAI_Program* program = new CreatureEventAI_Program;
+            program->events.reserve(filtered.size());
+
+            // group by type, stable so events of one type keep their order
+            for (uint32 type = 0; type < EVENT_T_END; ++type)
+            {
+                program->typeOffset[type] = uint16(program->events.size());
+                for (uint32 i = 0; i < filtered.size(); ++i)
+                    if (filtered[i]->event_type == type)
+                        program->events.push_back(*filtered[i]);
+            }
+            program->typeOffset[EVENT_T_END] = uint16(program->events.size());
+
+            // UpdateAI checks these in load order, as before the grouping
+            for (uint32 i = 0; i < filtered.size(); ++i)
+            {
+                if (!IsEventAIUpdateEvent(filtered[i]->event_type))
+                    continue;
+
+                uint32 type = filtered[i]->event_type;
+                for (uint32 j = program->typeOffset[type]; j < program->typeOffset[type + 1]; ++j)
+                {
+                    if (program->events[j].event_id == filtered[i]->event_id)
+                    {
+                        program->updateEvents.push_back(uint16(j));
+                        break;
+                    }
+                }
+            }
+
+            variants.variant[variant] = CreatureEventAI_ProgramPtr(program);
+        }
+    }
 }
 
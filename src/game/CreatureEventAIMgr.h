@@ -21,6 +21,13 @@
 #include "Common.h"
 #include "CreatureEventAI.h"
 
+struct CreatureEventAI_ProgramVariants
+{
+    CreatureEventAI_ProgramPtr variant[MAX_EVENTAI_VARIANTS];
+};
+
+typedef UNORDERED_MAP<uint32, CreatureEventAI_ProgramVariants> CreatureEventAI_Program_Map;
+
 class CreatureEventAIMgr
 {
     public:
@@ -35,6 +42,12 @@ class CreatureEventAIMgr
         {
             return m_CreatureEventAI_Event_Map;
         }
+        // null if the entry has no events
+        CreatureEventAI_ProgramPtr GetProgram(uint32 entry, EventAI_ProgramVariant variant) const
+        {
+            CreatureEventAI_Program_Map::const_iterator itr = m_CreatureEventAI_Program_Map.find(entry);
+            return itr != m_CreatureEventAI_Program_Map.end() ? itr->second.variant[variant] : CreatureEventAI_ProgramPtr();
+        }
         CreatureEventAI_Summon_Map const& GetCreatureEventAISummonMap() const
         {
             return m_CreatureEventAI_Summon_Map;
@@ -47,8 +60,10 @@ class CreatureEventAIMgr
     private:
         void CheckUnusedAITexts();
         void CheckUnusedAISummons();
+        void CompilePrograms();
 
         CreatureEventAI_Event_Map  m_CreatureEventAI_Event_Map;
+        CreatureEventAI_Program_Map m_CreatureEventAI_Program_Map;
         CreatureEventAI_Summon_Map m_CreatureEventAI_Summon_Map;
         CreatureEventAI_TextMap    m_CreatureEventAI_TextMap;
 };
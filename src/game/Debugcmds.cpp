@@ -781,3 +781,12 @@ bool ChatHandler::HandleDebugAnimationCommand(const char* args)
     return true;
 }
 
+
+// creature relocation notifies done by the last relocation pass of the current map
+bool ChatHandler::HandleDebugRelocationCommand(const char* /*args*/)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+    PSendSysMessage("Map %u instance %u: %u creatures relocated, %u unit pairs evaluated in the last relocation pass",
+                    map->GetId(), map->GetInstanceId(), map->GetRelocatedCreatures(), map->GetRelocationPairs());
+    return true;
+}
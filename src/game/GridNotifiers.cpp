@@ -159,54 +159,120 @@ void PlayerRelocationNotifier::Visit(CreatureMapType& m)
     }
 }
 
-void CreatureRelocationNotifier::Visit(PlayerMapType& m)
+void RelocatedCreatureCollector::Visit(CreatureMapType& m)
 {
-    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* pl = iter->GetSource();
+    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+        if (iter->GetSource()->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+            i_creatures.push_back(RelocatedCreature(iter->GetSource(), i_radius));
+}
 
-        if (!pl->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
-            pl->UpdateVisibilityOf(&i_creature);
+void RelocationNeighbourCollector::Visit(PlayerMapType& m)
+{
+    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+        i_players.push_back(iter->GetSource());
+}
 
-        CreatureUnitRelocationWorker(&i_creature, pl);
-    }
+void RelocationNeighbourCollector::Visit(CreatureMapType& m)
+{
+    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+        i_creatures.push_back(iter->GetSource());
 }
 
-void CreatureRelocationNotifier::Visit(CreatureMapType& m)
+void CreatureRelocationBatch::Process(CellCoord const& cell, std::vector<RelocatedCreature> const& creatures)
 {
-    if (!i_creature.IsAlive())
-        return;
+    // a single visit around the moved creatures, wide enough for their radius
+    float minX = creatures.front().creature->GetPositionX(), maxX = minX;
+    float minY = creatures.front().creature->GetPositionY(), maxY = minY;
+    float reach = 0.0f;
+    for (std::vector<RelocatedCreature>::const_iterator itr = creatures.begin(); itr != creatures.end(); ++itr)
+    {
+        minX = std::min(minX, itr->creature->GetPositionX());
+        maxX = std::max(maxX, itr->creature->GetPositionX());
+        minY = std::min(minY, itr->creature->GetPositionY());
+        maxY = std::max(maxY, itr->creature->GetPositionY());
+        reach = std::max(reach, itr->radius + itr->creature->GetObjectSize());
+    }
+    reach += 0.5f * sqrt((maxX - minX) * (maxX - minX) + (maxY - minY) * (maxY - minY));
 
-    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    i_players.clear();
+    i_creatures.clear();
+    RelocationNeighbourCollector collector(i_players, i_creatures);
+    TypeContainerVisitor<RelocationNeighbourCollector, WorldTypeMapContainer > world_collector(collector);
+    TypeContainerVisitor<RelocationNeighbourCollector, GridTypeMapContainer >  grid_collector(collector);
+
+    Cell standing(cell);
+    standing.SetNoCreate();
+    standing.Visit(cell, world_collector, i_map, reach, 0.5f * (minX + maxX), 0.5f * (minY + maxY));
+    standing.Visit(cell, grid_collector, i_map, reach, 0.5f * (minX + maxX), 0.5f * (minY + maxY));
+
+    i_playerCells.clear();
+    for (std::vector<Player*>::const_iterator itr = i_players.begin(); itr != i_players.end(); ++itr)
+        i_playerCells.push_back(Oregon::ComputeCellCoord((*itr)->GetPositionX(), (*itr)->GetPositionY()));
+
+    for (std::vector<RelocatedCreature>::const_iterator itr = creatures.begin(); itr != creatures.end(); ++itr)
     {
-        Creature* c = iter->GetSource();
+        Creature* creature = itr->creature;
 
-        //check distance to improve performance
-        if (!i_creature._IsWithinDist(c, i_radius, true))
+        // players in the cells a visit of the creature's own radius would reach
+        for (uint32 i = 0; i < i_players.size(); ++i)
+        {
+            if (!Cell::IsCellInRange(i_playerCells[i], creature->GetPositionX(), creature->GetPositionY(), itr->radius + creature->GetObjectSize()))
+                continue;
+
+            Player* player = i_players[i];
+            ++i_pairs;
+
+            if (!player->m_seer->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+                player->UpdateVisibilityOf(creature);
+
+            CreatureUnitRelocationWorker(creature, player);
+        }
+
+        if (!creature->IsAlive())
             continue;
 
-        CreatureUnitRelocationWorker(&i_creature, c);
+        for (std::vector<Creature*>::const_iterator c_itr = i_creatures.begin(); c_itr != i_creatures.end(); ++c_itr)
+        {
+            Creature* c = *c_itr;
+
+            // creatures of this batch are paired below
+            if (c->isNeedNotify(NOTIFY_VISIBILITY_CHANGED) && std::binary_search(creatures.begin(), creatures.end(), RelocatedCreature(c, 0.0f)))
+                continue;
+
+            if (!creature->_IsWithinDist(c, itr->radius, true))
+                continue;
 
-        if (!c->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
-            CreatureUnitRelocationWorker(c, &i_creature);
+            ++i_pairs;
+            CreatureUnitRelocationWorker(creature, c);
+
+            // a creature moved in another cell or batch sees this one from its own batch
+            if (!c->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+                CreatureUnitRelocationWorker(c, creature);
+        }
     }
-}
 
-void DelayedUnitRelocation::Visit(CreatureMapType& m)
-{
-    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    // both directions of a pair of moved creatures at once, the distance is shared when the radius is
+    for (std::vector<RelocatedCreature>::const_iterator first = creatures.begin(); first != creatures.end(); ++first)
     {
-        Creature* unit = iter->GetSource();
-        if (!unit->isNeedNotify(NOTIFY_VISIBILITY_CHANGED))
+        if (!first->creature->IsAlive())
             continue;
 
-        CreatureRelocationNotifier relocate(*unit, i_radius);
-
-        TypeContainerVisitor<CreatureRelocationNotifier, WorldTypeMapContainer > c2world_relocation(relocate);
-        TypeContainerVisitor<CreatureRelocationNotifier, GridTypeMapContainer >  c2grid_relocation(relocate);
-
-        cell.Visit(p, c2world_relocation, i_map, *unit, i_radius);
-        cell.Visit(p, c2grid_relocation, i_map, *unit, i_radius);
+        for (std::vector<RelocatedCreature>::const_iterator second = first + 1; second != creatures.end(); ++second)
+        {
+            if (!second->creature->IsAlive())
+                continue;
+
+            bool firstSees = first->creature->_IsWithinDist(second->creature, first->radius, true);
+            bool secondSees = first->radius == second->radius ? firstSees : second->creature->_IsWithinDist(first->creature, second->radius, true);
+            if (!firstSees && !secondSees)
+                continue;
+
+            ++i_pairs;
+            if (firstSees)
+                CreatureUnitRelocationWorker(first->creature, second->creature);
+            if (secondSees)
+                CreatureUnitRelocationWorker(second->creature, first->creature);
+        }
     }
 }
 
@@ -68,15 +68,54 @@ struct PlayerRelocationNotifier : public VisibleNotifier
     void Visit(PlayerMapType&);
 };
 
-struct CreatureRelocationNotifier
+// creature waiting for its relocation notify, radius is the one its surroundings are checked with
+struct RelocatedCreature
 {
-    Creature& i_creature;
+    RelocatedCreature(Creature* c, float r) : creature(c), radius(r) {}
+
+    bool operator<(RelocatedCreature const& other) const { return creature < other.creature; }
+
+    Creature* creature;
+    float radius;
+};
+
+// gathers the creatures of a cell flagged with NOTIFY_VISIBILITY_CHANGED
+struct RelocatedCreatureCollector
+{
+    std::vector<RelocatedCreature>& i_creatures;
     const float i_radius;
-    CreatureRelocationNotifier(Creature& c, float radius) :
-        i_creature(c), i_radius(radius) {}
+    RelocatedCreatureCollector(std::vector<RelocatedCreature>& creatures, float radius) :
+        i_creatures(creatures), i_radius(radius) {}
     template<class T> void Visit(GridRefManager<T>&) {}
     void Visit(CreatureMapType&);
+};
+
+// gathers the players and creatures around a cell
+struct RelocationNeighbourCollector
+{
+    std::vector<Player*>& i_players;
+    std::vector<Creature*>& i_creatures;
+    RelocationNeighbourCollector(std::vector<Player*>& players, std::vector<Creature*>& creatures) :
+        i_players(players), i_creatures(creatures) {}
+    template<class T> void Visit(GridRefManager<T>&) {}
     void Visit(PlayerMapType&);
+    void Visit(CreatureMapType&);
+};
+
+// Relocation notifies of the creatures moved within one cell and checked with the same
+// radius. Their surroundings are gathered once for the whole batch, and each pair of moved
+// creatures is checked once for both directions instead of once from each side.
+struct CreatureRelocationBatch
+{
+    Map& i_map;
+    uint32 i_pairs;                                         // unit pairs handed to the relocation workers
+    std::vector<Player*> i_players;
+    std::vector<CellCoord> i_playerCells;
+    std::vector<Creature*> i_creatures;
+
+    explicit CreatureRelocationBatch(Map& map) : i_map(map), i_pairs(0) {}
+    // creatures must all stand in cell and be sorted
+    void Process(CellCoord const& cell, std::vector<RelocatedCreature> const& creatures);
 };
 
 struct DelayedUnitRelocation
@@ -88,7 +127,6 @@ struct DelayedUnitRelocation
     DelayedUnitRelocation(Cell& c, CellCoord& pair, Map& map, float radius) :
         i_map(map), cell(c), p(pair), i_radius(radius) {}
     template<class T> void Visit(GridRefManager<T>&) {}
-    void Visit(CreatureMapType&);
     void Visit(PlayerMapType&);
 };
 
@@ -885,16 +923,17 @@ class AnyAoETargetUnitInObjectRangeCheck
         }
         bool operator()(Unit* u)
         {
+            // distance first, most units of the visited cells are out of range
+            if (!i_obj->IsWithinDistInMap(u, i_range))
+                return false;
+
             // Check contains checks for: live, non-selectable, non-attackable flags, flight check and GM check, ignore totems
             if (!u->isTargetableForAttack())
                 return false;
             if (u->GetTypeId() == TYPEID_UNIT && u->IsTotem())
                 return false;
 
-            if ((i_targetForPlayer ? !i_funit->IsFriendlyTo(u) : i_funit->IsHostileTo(u)) && i_obj->IsWithinDistInMap(u, i_range))
-                return true;
-
-            return false;
+            return i_targetForPlayer ? !i_funit->IsFriendlyTo(u) : i_funit->IsHostileTo(u);
         }
     private:
         bool i_targetForPlayer;
@@ -1027,13 +1066,13 @@ class AnyAssistCreatureInRangeCheck
             if (u == i_funit)
                 return false;
 
-            if (!u->CanAssistTo(i_funit, i_enemy))
-                return false;
-
             // too far
             if (!i_funit->IsWithinDistInMap(u, i_range))
                 return false;
 
+            if (!u->CanAssistTo(i_funit, i_enemy))
+                return false;
+
             // only if see assisted creature
             if (!i_funit->IsWithinLOSInMap(u))
                 return false;
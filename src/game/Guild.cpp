@@ -46,6 +46,9 @@ Guild::Guild()
     m_GuildBankMoney = 0;
     m_PurchasedTabs = 0;
 
+    m_RosterCached = false;
+    m_RosterCacheTime = 0;
+
     m_GuildEventLogNextGuid = 0;
     m_GuildBankEventLogNextGuid_Money = 0;
 
@@ -165,9 +168,11 @@ bool Guild::AddMember(uint64 plGuid, uint32 plRank)
         pl->SetInGuild(m_Id);
         pl->SetRank(newmember.RankId);
         pl->SetGuildIdInvited(0);
+        m_OnlineMembers[GUID_LOPART(plGuid)] = pl;
     }
 
     UpdateAccountsNumber();
+    InvalidateRoster();
 
     return true;
 }
@@ -175,6 +180,7 @@ bool Guild::AddMember(uint64 plGuid, uint32 plRank)
 void Guild::SetMOTD(std::string motd)
 {
     MOTD = motd;
+    InvalidateRoster();
 
     // motd now can be used for encoding to DB
     CharacterDatabase.escape_string(motd);
@@ -184,6 +190,7 @@ void Guild::SetMOTD(std::string motd)
 void Guild::SetGINFO(std::string ginfo)
 {
     GINFO = ginfo;
+    InvalidateRoster();
 
     // ginfo now can be used for encoding to DB
     CharacterDatabase.escape_string(ginfo);
@@ -471,6 +478,7 @@ void Guild::LoadPlayerStatsByGuid(uint64 guid)
     itr->second.Name  = pl->GetName();
     itr->second.Level = pl->getLevel();
     itr->second.Class = pl->getClass();
+    InvalidateRoster();
 }
 
 void Guild::SetLeader(uint64 guid)
@@ -524,6 +532,8 @@ void Guild::DelMember(uint64 guid, bool isDisbanding)
     }
 
     members.erase(GUID_LOPART(guid));
+    m_OnlineMembers.erase(GUID_LOPART(guid));
+    InvalidateRoster();
 
     Player* player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
@@ -541,6 +551,7 @@ void Guild::ChangeRank(uint64 guid, uint32 newRank)
     MemberList::iterator itr = members.find(GUID_LOPART(guid));
     if (itr != members.end())
         itr->second.RankId = newRank;
+    InvalidateRoster();
 
     Player* player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
@@ -557,6 +568,7 @@ void Guild::SetPNOTE(uint64 guid, std::string pnote)
         return;
 
     itr->second.Pnote = pnote;
+    InvalidateRoster();
 
     // pnote now can be used for encoding to DB
     CharacterDatabase.escape_string(pnote);
@@ -569,6 +581,7 @@ void Guild::SetOFFNOTE(uint64 guid, std::string offnote)
     if (itr == members.end())
         return;
     itr->second.OFFnote = offnote;
+    InvalidateRoster();
     // offnote now can be used for encoding to DB
     CharacterDatabase.escape_string(offnote);
     CharacterDatabase.PExecute("UPDATE guild_member SET offnote = '%s' WHERE guid = '%u'", offnote.c_str(), itr->first);
@@ -581,11 +594,11 @@ void Guild::BroadcastToGuild(WorldSession* session, const std::string& msg, uint
         WorldPacket data;
         ChatHandler(session).FillMessageData(&data, CHAT_MSG_GUILD, language, 0, msg.c_str());
 
-        for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+        for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
         {
-            Player* pl = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
+            Player* pl = itr->second;
 
-            if (pl && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_GCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()))
+            if (pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_GCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()))
                 pl->GetSession()->SendPacket(&data);
         }
     }
@@ -595,14 +608,14 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 {
     if (session && session->GetPlayer() && HasRankRight(session->GetPlayer()->GetRank(), GR_RIGHT_OFFCHATSPEAK))
     {
-        for (MemberList::iterator itr = members.begin(); itr != members.end(); ++itr)
-        {
-            WorldPacket data;
-            ChatHandler::FillMessageData(&data, session, CHAT_MSG_OFFICER, language, NULL, 0, msg.c_str(), NULL);
+        WorldPacket data;
+        ChatHandler::FillMessageData(&data, session, CHAT_MSG_OFFICER, language, NULL, 0, msg.c_str(), NULL);
 
-            Player* pl = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER), true);
+        for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
+        {
+            Player* pl = itr->second;
 
-            if (pl && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_OFFCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()))
+            if (pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_OFFCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()))
                 pl->GetSession()->SendPacket(&data);
         }
     }
@@ -610,24 +623,17 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket* packet)
 {
-    for (MemberList::iterator itr = members.begin(); itr != members.end(); ++itr)
-    {
-        Player* player = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER), true);
-        if (player)
-            player->GetSession()->SendPacket(packet);
-    }
+    for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
+        itr->second->GetSession()->SendPacket(packet);
 }
 
 void Guild::BroadcastPacketToRank(WorldPacket* packet, uint32 rankId)
 {
-    for (MemberList::iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
     {
-        if (itr->second.RankId == rankId)
-        {
-            Player* player = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER), true);
-            if (player)
-                player->GetSession()->SendPacket(packet);
-        }
+        MemberList::const_iterator mitr = members.find(itr->first);
+        if (mitr != members.end() && mitr->second.RankId == rankId)
+            itr->second->GetSession()->SendPacket(packet);
     }
 }
 
@@ -651,6 +657,7 @@ void Guild::CreateRank(std::string name_, uint32 rights)
 void Guild::AddRank(const std::string& name_, uint32 rights, uint32 money)
 {
     m_Ranks.push_back(RankInfo(name_, rights, money));
+    InvalidateRoster();
 }
 
 void Guild::DelRank()
@@ -664,6 +671,7 @@ void Guild::DelRank()
     CharacterDatabase.PExecute("DELETE FROM guild_bank_right WHERE rid>='%u' AND guildid='%u'", rank, m_Id);
 
     m_Ranks.pop_back();
+    InvalidateRoster();
 }
 
 std::string Guild::GetRankName(uint32 rankId)
@@ -700,6 +708,7 @@ void Guild::SetRankRights(uint32 rankId, uint32 rights)
         return;
 
     m_Ranks[rankId].Rights = rights;
+    InvalidateRoster();
 
     CharacterDatabase.PExecute("UPDATE guild_rank SET rights='%u' WHERE rid='%u' AND guildid='%u'", rights, (rankId + 1), m_Id);
 }
@@ -735,59 +744,79 @@ void Guild::Disband()
     sObjectMgr.RemoveGuild(m_Id);
 }
 
-void Guild::Roster(WorldSession* session /*= NULL*/)
+// online members keep the level and zone of their slot current, returns true if any of them changed
+bool Guild::UpdateOnlineMemberStats()
+{
+    bool changed = false;
+    for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
+    {
+        MemberList::iterator mitr = members.find(itr->first);
+        if (mitr == members.end())
+            continue;
+
+        Player* pl = itr->second;
+        if (mitr->second.Level != pl->getLevel() || mitr->second.ZoneId != pl->GetZoneId())
+        {
+            mitr->second.Level = pl->getLevel();
+            mitr->second.ZoneId = pl->GetZoneId();
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void Guild::BuildRosterPacket()
 {
     // we can only guess size
-    WorldPacket data(SMSG_GUILD_ROSTER, (4 + MOTD.length() + 1 + GINFO.length() + 1 + 4 + m_Ranks.size() * (4 + 4 + GUILD_BANK_MAX_TABS * (4 + 4)) + members.size() * 50));
-    data << uint32(members.size());
-    data << MOTD;
-    data << GINFO;
+    m_RosterPacket.Initialize(SMSG_GUILD_ROSTER, (4 + MOTD.length() + 1 + GINFO.length() + 1 + 4 + m_Ranks.size() * (4 + 4 + GUILD_BANK_MAX_TABS * (4 + 4)) + members.size() * 50));
+    m_RosterPacket << uint32(members.size());
+    m_RosterPacket << MOTD;
+    m_RosterPacket << GINFO;
 
-    data << uint32(m_Ranks.size());
+    m_RosterPacket << uint32(m_Ranks.size());
     for (RankList::const_iterator ritr = m_Ranks.begin(); ritr != m_Ranks.end(); ++ritr)
     {
-        data << uint32(ritr->Rights);
-        data << uint32(ritr->BankMoneyPerDay);              // count of: withdraw gold(gold/day) Note: in game set gold, in packet set bronze.
+        m_RosterPacket << uint32(ritr->Rights);
+        m_RosterPacket << uint32(ritr->BankMoneyPerDay);    // count of: withdraw gold(gold/day) Note: in game set gold, in packet set bronze.
         for (int i = 0; i < GUILD_BANK_MAX_TABS; ++i)
         {
-            data << uint32(ritr->TabRight[i]);              // for TAB_i rights: view tabs = 0x01, deposit items =0x02
-            data << uint32(ritr->TabSlotPerDay[i]);         // for TAB_i count of: withdraw items(stack/day)
+            m_RosterPacket << uint32(ritr->TabRight[i]);    // for TAB_i rights: view tabs = 0x01, deposit items =0x02
+            m_RosterPacket << uint32(ritr->TabSlotPerDay[i]); // for TAB_i count of: withdraw items(stack/day)
         }
     }
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
-        if (Player* pl = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER)))
-        {
-            data << uint64(pl->GetGUID());
-            data << uint8(1);
-            data << pl->GetName();
-            data << uint32(itr->second.RankId);
-            data << uint8(pl->getLevel());
-            data << uint8(pl->getClass());
-            data << uint8(0);                               // new 2.4.0
-            data << uint32(pl->GetZoneId());
-            data << itr->second.Pnote;
-            data << itr->second.OFFnote;
-        }
-        else
-        {
-            data << uint64(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
-            data << uint8(0);
-            data << itr->second.Name;
-            data << uint32(itr->second.RankId);
-            data << uint8(itr->second.Level);
-            data << uint8(itr->second.Class);
-            data << uint8(0);                               // new 2.4.0
-            data << uint32(itr->second.ZoneId);
-            data << float(float(time(NULL) - itr->second.LogoutTime) / DAY);
-            data << itr->second.Pnote;
-            data << itr->second.OFFnote;
-        }
+        // level and zone of online members were taken from the player by UpdateOnlineMemberStats
+        bool online = m_OnlineMembers.find(itr->first) != m_OnlineMembers.end();
+
+        m_RosterPacket << uint64(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
+        m_RosterPacket << uint8(online ? 1 : 0);
+        m_RosterPacket << itr->second.Name;
+        m_RosterPacket << uint32(itr->second.RankId);
+        m_RosterPacket << uint8(itr->second.Level);
+        m_RosterPacket << uint8(itr->second.Class);
+        m_RosterPacket << uint8(0);                         // new 2.4.0
+        m_RosterPacket << uint32(itr->second.ZoneId);
+        if (!online)
+            m_RosterPacket << float(float(time(NULL) - itr->second.LogoutTime) / DAY);
+        m_RosterPacket << itr->second.Pnote;
+        m_RosterPacket << itr->second.OFFnote;
     }
+
+    m_RosterCached = true;
+    m_RosterCacheTime = time(NULL);
+}
+
+void Guild::Roster(WorldSession* session /*= NULL*/)
+{
+    // level and zone changes of online members are not reported to the guild, so they are checked here
+    if (UpdateOnlineMemberStats() || !m_RosterCached || time(NULL) >= m_RosterCacheTime + GUILD_ROSTER_CACHE_TIME)
+        BuildRosterPacket();
+
     if (session)
-        session->SendPacket(&data);
+        session->SendPacket(&m_RosterPacket);
     else
-        BroadcastPacket(&data);
+        BroadcastPacket(&m_RosterPacket);
     sLog.outDebug("WORLD: Sent (SMSG_GUILD_ROSTER)");
 }
 
@@ -827,6 +856,15 @@ void Guild::SetEmblem(uint32 emblemStyle, uint32 emblemColor, uint32 borderStyle
     CharacterDatabase.PExecute("UPDATE guild SET EmblemStyle=%u, EmblemColor=%u, BorderStyle=%u, BorderColor=%u, BackgroundColor=%u WHERE guildid = %u", m_EmblemStyle, m_EmblemColor, m_BorderStyle, m_BorderColor, m_BackgroundColor, m_Id);
 }
 
+void Guild::SetMemberOnline(Player* player)
+{
+    if (members.find(player->GetGUIDLow()) == members.end())
+        return;
+
+    m_OnlineMembers[player->GetGUIDLow()] = player;
+    InvalidateRoster();
+}
+
 void Guild::UpdateLogoutTime(uint64 guid)
 {
     MemberList::iterator itr = members.find(GUID_LOPART(guid));
@@ -834,6 +872,8 @@ void Guild::UpdateLogoutTime(uint64 guid)
         return;
 
     itr->second.LogoutTime = time(NULL);
+    m_OnlineMembers.erase(GUID_LOPART(guid));
+    InvalidateRoster();
 
     if (m_onlinemembers > 0)
         --m_onlinemembers;
@@ -1049,11 +1089,9 @@ void Guild::DisplayGuildBankContentUpdate(uint8 TabId, int32 slot1, int32 slot2)
         AppendDisplayGuildBankSlot(data, tab, slot2);
     }
 
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
     {
-        Player* player = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
-        if (!player)
-            continue;
+        Player* player = itr->second;
 
         if (!IsMemberHaveRights(itr->first, TabId, GUILD_BANK_RIGHT_VIEW_TAB))
             continue;
@@ -1086,11 +1124,9 @@ void Guild::DisplayGuildBankContentUpdate(uint8 TabId, GuildItemPosCountVec cons
     for (GuildItemPosCountVec::const_iterator itr = slots.begin(); itr != slots.end(); ++itr)
         AppendDisplayGuildBankSlot(data, tab, itr->Slot);
 
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (OnlineMemberList::const_iterator itr = m_OnlineMembers.begin(); itr != m_OnlineMembers.end(); ++itr)
     {
-        Player* player = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
-        if (!player)
-            continue;
+        Player* player = itr->second;
 
         if (!IsMemberHaveRights(itr->first, TabId, GUILD_BANK_RIGHT_VIEW_TAB))
             continue;
@@ -1186,6 +1222,7 @@ void Guild::CreateBankRightForTab(uint32 rankId, uint8 TabId)
 
     m_Ranks[rankId].TabRight[TabId] = 0;
     m_Ranks[rankId].TabSlotPerDay[TabId] = 0;
+    InvalidateRoster();
     CharacterDatabase.BeginTransaction();
     CharacterDatabase.PExecute("DELETE FROM guild_bank_right WHERE guildid = '%u' AND TabId = '%u' AND rid = '%u'", m_Id, uint32(TabId), rankId);
     CharacterDatabase.PExecute("INSERT INTO guild_bank_right (guildid,TabId,rid) VALUES ('%u','%u','%u')", m_Id, uint32(TabId), rankId);
@@ -1437,6 +1474,7 @@ void Guild::SetBankMoneyPerDay(uint32 rankId, uint32 money)
         money = WITHDRAW_MONEY_UNLIMITED;
 
     m_Ranks[rankId].BankMoneyPerDay = money;
+    InvalidateRoster();
 
     for (MemberList::iterator itr = members.begin(); itr != members.end(); ++itr)
         if (itr->second.RankId == rankId)
@@ -1465,6 +1503,7 @@ void Guild::SetBankRightsAndSlots(uint32 rankId, uint8 TabId, uint32 right, uint
 
     m_Ranks[rankId].TabSlotPerDay[TabId] = nbSlots;
     m_Ranks[rankId].TabRight[TabId] = right;
+    InvalidateRoster();
 
     if (db)
     {
@@ -28,6 +28,9 @@ class Item;
 #define GUILD_RANKS_MIN_COUNT   5
 #define GUILD_RANKS_MAX_COUNT   10
 
+// the cached roster is rebuilt at least this often, for the offline time of the members
+#define GUILD_ROSTER_CACHE_TIME 60
+
 enum GuildDefaultRanks
 {
     GR_GUILDMASTER  = 0,
@@ -410,6 +413,7 @@ class Guild
         void Roster(WorldSession* session = NULL);          // NULL = broadcast
         void Query(WorldSession* session);
 
+        void SetMemberOnline(Player* player);
         void UpdateLogoutTime(uint64 guid);
         // Guild eventlog
         void   LoadGuildEventLogFromDB();
@@ -505,6 +509,15 @@ class Guild
 
         MemberList members;
 
+        // members logged in right now, so broadcasts don't have to look up every member
+        typedef std::map<uint32, Player*> OnlineMemberList;
+        OnlineMemberList m_OnlineMembers;
+
+        // SMSG_GUILD_ROSTER as last sent, rebuilt when something in it has changed
+        WorldPacket m_RosterPacket;
+        bool m_RosterCached;
+        time_t m_RosterCacheTime;
+
         typedef std::vector<GuildBankTab*> TabListMap;
         TabListMap m_TabListMap;
 
@@ -529,6 +542,9 @@ class Guild
         uint32 GuildEventlogMaxGuid;
     private:
         void UpdateAccountsNumber();
+        void InvalidateRoster() { m_RosterCached = false; }
+        bool UpdateOnlineMemberStats();
+        void BuildRosterPacket();
         // internal common parts for CanStore/StoreItem functions
         void AppendDisplayGuildBankSlot(WorldPacket& data, GuildBankTab const* tab, int32 slot);
         uint8 _CanStoreItem_InSpecificSlot(uint8 tab, uint8 slot, GuildItemPosCountVec& dest, uint32& count, bool swap, Item* pSrcItem) const;
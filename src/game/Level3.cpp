@@ -54,6 +54,7 @@
 #include "DisableMgr.h"
 #include "ConditionMgr.h"
 #include "ScriptMgr.h"
+#include "LookupIndex.h"
 
 bool ChatHandler::HandleAHBotOptionsCommand(const char* args)
 {
@@ -695,6 +696,7 @@ bool ChatHandler::HandleReloadQuestTemplateCommand(const char*)
 {
     sLog.outString("Re-Loading Quest Templates...");
     sObjectMgr.LoadQuests();
+    sLookupIndex.Clear(LOOKUP_QUEST);
     SendGlobalGMSysMessage("DB table quest_template (quest definitions) reloaded.");
     return true;
 }
@@ -890,6 +892,7 @@ bool ChatHandler::HandleReloadSpellGroupsCommand(const char*)
 {
     sLog.outString("Re-Loading Spell Groups...");
     sSpellMgr.LoadSpellGroups();
+    sSpellMgr.LoadSpellInfo();
     SendGlobalGMSysMessage("DB table `spell_group` (spell elixir types) reloaded.");
     return true;
 }
@@ -1156,6 +1159,7 @@ bool ChatHandler::HandleReloadLocalesCreatureCommand(const char* /*arg*/)
 {
     sLog.outString("Re-Loading Locales Creature ...");
     sObjectMgr.LoadCreatureLocales();
+    sLookupIndex.Clear(LOOKUP_CREATURE);
     SendGlobalGMSysMessage("DB table locales_creature reloaded.");
     return true;
 }
@@ -1164,6 +1168,7 @@ bool ChatHandler::HandleReloadLocalesGameobjectCommand(const char* /*arg*/)
 {
     sLog.outString("Re-Loading Locales Gameobject ... ");
     sObjectMgr.LoadGameObjectLocales();
+    sLookupIndex.Clear(LOOKUP_GAMEOBJECT);
     SendGlobalGMSysMessage("DB table locales_gameobject reloaded.");
     return true;
 }
@@ -1172,6 +1177,7 @@ bool ChatHandler::HandleReloadLocalesItemCommand(const char* /*arg*/)
 {
     sLog.outString("Re-Loading Locales Item ... ");
     sObjectMgr.LoadItemLocales();
+    sLookupIndex.Clear(LOOKUP_ITEM);
     SendGlobalGMSysMessage("DB table locales_item reloaded.");
     return true;
 }
@@ -1196,6 +1202,7 @@ bool ChatHandler::HandleReloadLocalesQuestCommand(const char* /*arg*/)
 {
     sLog.outString("Re-Loading Locales Quest ... ");
     sObjectMgr.LoadQuestLocales();
+    sLookupIndex.Clear(LOOKUP_QUEST);
     SendGlobalGMSysMessage("DB table locales_quest reloaded.");
     return true;
 }
@@ -3127,65 +3134,36 @@ bool ChatHandler::HandleLookupItemCommand(const char* args)
     uint32 count = 0;
     uint32 maxResults = sWorld.getConfig(CONFIG_MAX_RESULTS_LOOKUP_COMMANDS);
 
+    int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
+    LookupNames const& names = sLookupIndex.GetNames(LOOKUP_ITEM, -1);
+    LookupNames const* locNames = loc_idx >= 0 ? &sLookupIndex.GetNames(LOOKUP_ITEM, loc_idx) : NULL;
+
     // Search in item_template
-    for (uint32 id = 0; id < sItemStorage.MaxEntry; id++)
+    for (size_t i = 0; i < names.Ids.size(); ++i)
     {
-        ItemTemplate const* pProto = sItemStorage.LookupEntry<ItemTemplate >(id);
-        if (!pProto)
-            continue;
-
-        int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
-        if (loc_idx >= 0)
-        {
-            ItemLocale const* il = sObjectMgr.GetItemLocale(pProto->ItemId);
-            if (il)
-            {
-                if (il->Name.size() > uint32(loc_idx) && !il->Name[loc_idx].empty())
-                {
-                    std::string name = il->Name[loc_idx];
-
-                    if (Utf8FitTo(name, wnamepart))
-                    {
-                        if (maxResults && count++ == maxResults)
-                        {
-                            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                            return true;
-                        }
-
-                        if (m_session)
-                            PSendSysMessage(LANG_ITEM_LIST_CHAT, id, id, name.c_str());
-                        else
-                            PSendSysMessage(LANG_ITEM_LIST_CONSOLE, id, name.c_str());
+        uint32 id = names.Ids[i];
+        std::string name;
 
-                        if (!found)
-                            found = true;
-
-                        continue;
-                    }
-                }
-            }
-        }
-
-        std::string name = pProto->Name1;
-        if (name.empty())
+        if (locNames && locNames->Fits(i, wnamepart))
+            name = sObjectMgr.GetItemLocale(id)->Name[loc_idx];
+        else if (names.Fits(i, wnamepart))
+            name = sItemStorage.LookupEntry<ItemTemplate>(id)->Name1;
+        else
             continue;
 
-        if (Utf8FitTo(name, wnamepart))
+        if (maxResults && count++ == maxResults)
         {
-            if (maxResults && count++ == maxResults)
-            {
-                PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                return true;
-            }
+            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
+            return true;
+        }
 
-            if (m_session)
-                PSendSysMessage(LANG_ITEM_LIST_CHAT, id, id, name.c_str());
-            else
-                PSendSysMessage(LANG_ITEM_LIST_CONSOLE, id, name.c_str());
+        if (m_session)
+            PSendSysMessage(LANG_ITEM_LIST_CHAT, id, id, name.c_str());
+        else
+            PSendSysMessage(LANG_ITEM_LIST_CONSOLE, id, name.c_str());
 
-            if (!found)
-                found = true;
-        }
+        if (!found)
+            found = true;
     }
 
     if (!found)
@@ -3362,87 +3340,86 @@ bool ChatHandler::HandleLookupSpellCommand(const char* args)
     uint32 count = 0;
     uint32 maxResults = sWorld.getConfig(CONFIG_MAX_RESULTS_LOOKUP_COMMANDS);
 
+    int sessionLoc = m_session ? int(m_session->GetSessionDbcLocale()) : sWorld.GetDefaultDbcLocale();
+    LookupNames const& names = sLookupIndex.GetNames(LOOKUP_SPELL, sessionLoc);
+
     // Search in Spell.dbc
-    for (uint32 id = 0; id < sSpellStore.GetNumRows(); id++)
+    for (size_t i = 0; i < names.Ids.size(); ++i)
     {
+        uint32 id = names.Ids[i];
         SpellEntry const* spellInfo = sSpellStore.LookupEntry(id);
-        if (spellInfo)
-        {
-            int loc = m_session ? int(m_session->GetSessionDbcLocale()) : sWorld.GetDefaultDbcLocale();
-            std::string name = spellInfo->SpellName[loc];
-            if (name.empty())
-                continue;
 
-            if (!Utf8FitTo(name, wnamepart))
-            {
-                loc = 0;
-                for (; loc < MAX_LOCALE; ++loc)
-                {
-                    if (m_session && loc == m_session->GetSessionDbcLocale())
-                        continue;
+        int loc = sessionLoc;
+        if (names.Names[i].empty())
+            continue;
 
-                    name = spellInfo->SpellName[loc];
-                    if (name.empty())
-                        continue;
+        if (!names.Fits(i, wnamepart))
+        {
+            loc = 0;
+            for (; loc < MAX_LOCALE; ++loc)
+            {
+                if (m_session && loc == m_session->GetSessionDbcLocale())
+                    continue;
 
-                    if (Utf8FitTo(name, wnamepart))
-                        break;
-                }
+                if (sLookupIndex.GetNames(LOOKUP_SPELL, loc).Fits(i, wnamepart))
+                    break;
             }
+        }
 
-            if (loc < MAX_LOCALE)
+        if (loc < MAX_LOCALE)
+        {
+            std::string name = spellInfo->SpellName[loc];
+
+            if (maxResults && count++ == maxResults)
             {
-                if (maxResults && count++ == maxResults)
-                {
-                    PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                    return true;
-                }
+                PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
+                return true;
+            }
 
-                bool known = target && target->HasSpell(id);
-                bool learn = (spellInfo->Effect[0] == SPELL_EFFECT_LEARN_SPELL);
+            bool known = target && target->HasSpell(id);
+            bool learn = (spellInfo->Effect[0] == SPELL_EFFECT_LEARN_SPELL);
 
-                uint32 talentCost = GetTalentSpellCost(id);
+            uint32 talentCost = GetTalentSpellCost(id);
 
-                bool talent = (talentCost > 0);
-                bool passive = IsPassiveSpell(id);
-                bool active = target && (target->HasAura(id, 0) || target->HasAura(id, 1) || target->HasAura(id, 2));
+            bool talent = (talentCost > 0);
+            bool passive = IsPassiveSpell(id);
+            bool active = target && (target->HasAura(id, 0) || target->HasAura(id, 1) || target->HasAura(id, 2));
 
-                // unit32 used to prevent interpreting uint8 as char at output
-                // find rank of learned spell for learning spell, or talent rank
-                uint32 rank = talentCost ? talentCost : sSpellMgr.GetSpellRank(learn ? spellInfo->EffectTriggerSpell[0] : id);
+            // unit32 used to prevent interpreting uint8 as char at output
+            // find rank of learned spell for learning spell, or talent rank
+            uint32 rank = talentCost ? talentCost : sSpellMgr.GetSpellRank(learn ? spellInfo->EffectTriggerSpell[0] : id);
 
-                // send spell in "id - [name, rank N] [talent] [passive] [learn] [known]" format
-                std::ostringstream ss;
-                if (m_session)
-                    ss << id << " - |cffffffff|Hspell:" << id << "|h[" << name;
-                else
-                    ss << id << " - " << name;
+            // send spell in "id - [name, rank N] [talent] [passive] [learn] [known]" format
+            std::ostringstream ss;
+            if (m_session)
+                ss << id << " - |cffffffff|Hspell:" << id << "|h[" << name;
+            else
+                ss << id << " - " << name;
 
-                // include rank in link name
-                if (rank)
-                    ss << GetOregonString(LANG_SPELL_RANK) << rank;
+            // include rank in link name
+            if (rank)
+                ss << GetOregonString(LANG_SPELL_RANK) << rank;
 
-                if (m_session)
-                    ss << " " << localeNames[loc] << "]|h|r";
-                else
-                    ss << " " << localeNames[loc];
+            if (m_session)
+                ss << " " << localeNames[loc] << "]|h|r";
+            else
+                ss << " " << localeNames[loc];
 
-                if (talent)
-                    ss << GetOregonString(LANG_TALENT);
-                if (passive)
-                    ss << GetOregonString(LANG_PASSIVE);
-                if (learn)
-                    ss << GetOregonString(LANG_LEARN);
-                if (known)
-                    ss << GetOregonString(LANG_KNOWN);
-                if (active)
-                    ss << GetOregonString(LANG_ACTIVE);
+            if (talent)
+                ss << GetOregonString(LANG_TALENT);
+            if (passive)
+                ss << GetOregonString(LANG_PASSIVE);
+            if (learn)
+                ss << GetOregonString(LANG_LEARN);
+            if (known)
+                ss << GetOregonString(LANG_KNOWN);
+            if (active)
+                ss << GetOregonString(LANG_ACTIVE);
 
-                SendSysMessage(ss.str().c_str());
+            SendSysMessage(ss.str().c_str());
 
-                if (!found)
-                    found = true;
-            }
+            if (!found)
+                found = true;
         }
     }
     if (!found)
@@ -3471,97 +3448,52 @@ bool ChatHandler::HandleLookupQuestCommand(const char* args)
     uint32 count = 0;
     uint32 maxResults = sWorld.getConfig(CONFIG_MAX_RESULTS_LOOKUP_COMMANDS);
 
-    ObjectMgr::QuestMap const& qTemplates = sObjectMgr.GetQuestTemplates();
-    for (ObjectMgr::QuestMap::const_iterator iter = qTemplates.begin(); iter != qTemplates.end(); ++iter)
-    {
-        Quest* qinfo = iter->second;
+    int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
+    LookupNames const& names = sLookupIndex.GetNames(LOOKUP_QUEST, -1);
+    LookupNames const* locNames = loc_idx >= 0 ? &sLookupIndex.GetNames(LOOKUP_QUEST, loc_idx) : NULL;
 
-        int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
-        if (loc_idx >= 0)
-        {
-            QuestLocale const* il = sObjectMgr.GetQuestLocale(qinfo->GetQuestId());
-            if (il)
-            {
-                if (il->Title.size() > uint32(loc_idx) && !il->Title[loc_idx].empty())
-                {
-                    std::string title = il->Title[loc_idx];
+    for (size_t i = 0; i < names.Ids.size(); ++i)
+    {
+        uint32 questId = names.Ids[i];
+        std::string title;
 
-                    if (Utf8FitTo(title, wnamepart))
-                    {
-                        if (maxResults && count++ == maxResults)
-                        {
-                            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                            return true;
-                        }
-
-                        char const* statusStr = "";
-
-                        if (target)
-                        {
-                            QuestStatus status = target->GetQuestStatus(qinfo->GetQuestId());
-
-                            if (status == QUEST_STATUS_COMPLETE)
-                            {
-                                if (target->GetQuestRewardStatus(qinfo->GetQuestId()))
-                                    statusStr = GetOregonString(LANG_COMMAND_QUEST_REWARDED);
-                                else
-                                    statusStr = GetOregonString(LANG_COMMAND_QUEST_COMPLETE);
-                            }
-                            else if (status == QUEST_STATUS_INCOMPLETE)
-                                statusStr = GetOregonString(LANG_COMMAND_QUEST_ACTIVE);
-                        }
-
-                        if (m_session)
-                            PSendSysMessage(LANG_QUEST_LIST_CHAT, qinfo->GetQuestId(), qinfo->GetQuestId(), title.c_str(), statusStr);
-                        else
-                            PSendSysMessage(LANG_QUEST_LIST_CONSOLE, qinfo->GetQuestId(), title.c_str(), statusStr);
-
-                        if (!found)
-                            found = true;
+        if (locNames && locNames->Fits(i, wnamepart))
+            title = sObjectMgr.GetQuestLocale(questId)->Title[loc_idx];
+        else if (names.Fits(i, wnamepart))
+            title = sObjectMgr.GetQuestTemplate(questId)->GetTitle();
+        else
+            continue;
 
-                        continue;
-                    }
-                }
-            }
+        if (maxResults && count++ == maxResults)
+        {
+            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
+            return true;
         }
 
-        std::string title = qinfo->GetTitle();
-        if (title.empty())
-            continue;
+        char const* statusStr = "";
 
-        if (Utf8FitTo(title, wnamepart))
+        if (target)
         {
-            if (maxResults && count++ == maxResults)
-            {
-                PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                return true;
-            }
-
-            char const* statusStr = "";
+            QuestStatus status = target->GetQuestStatus(questId);
 
-            if (target)
+            if (status == QUEST_STATUS_COMPLETE)
             {
-                QuestStatus status = target->GetQuestStatus(qinfo->GetQuestId());
-
-                if (status == QUEST_STATUS_COMPLETE)
-                {
-                    if (target->GetQuestRewardStatus(qinfo->GetQuestId()))
-                        statusStr = GetOregonString(LANG_COMMAND_QUEST_REWARDED);
-                    else
-                        statusStr = GetOregonString(LANG_COMMAND_QUEST_COMPLETE);
-                }
-                else if (status == QUEST_STATUS_INCOMPLETE)
-                    statusStr = GetOregonString(LANG_COMMAND_QUEST_ACTIVE);
+                if (target->GetQuestRewardStatus(questId))
+                    statusStr = GetOregonString(LANG_COMMAND_QUEST_REWARDED);
+                else
+                    statusStr = GetOregonString(LANG_COMMAND_QUEST_COMPLETE);
             }
+            else if (status == QUEST_STATUS_INCOMPLETE)
+                statusStr = GetOregonString(LANG_COMMAND_QUEST_ACTIVE);
+        }
 
-            if (m_session)
-                PSendSysMessage(LANG_QUEST_LIST_CHAT, qinfo->GetQuestId(), qinfo->GetQuestId(), title.c_str(), statusStr);
-            else
-                PSendSysMessage(LANG_QUEST_LIST_CONSOLE, qinfo->GetQuestId(), title.c_str(), statusStr);
+        if (m_session)
+            PSendSysMessage(LANG_QUEST_LIST_CHAT, questId, questId, title.c_str(), statusStr);
+        else
+            PSendSysMessage(LANG_QUEST_LIST_CONSOLE, questId, title.c_str(), statusStr);
 
-            if (!found)
-                found = true;
-        }
+        if (!found)
+            found = true;
     }
 
     if (!found)
@@ -3588,64 +3520,35 @@ bool ChatHandler::HandleLookupCreatureCommand(const char* args)
     uint32 count = 0;
     uint32 maxResults = sWorld.getConfig(CONFIG_MAX_RESULTS_LOOKUP_COMMANDS);
 
-    for (uint32 id = 0; id < sCreatureStorage.MaxEntry; ++id)
-    {
-        CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo> (id);
-        if (!cInfo)
-            continue;
-
-        int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
-        if (loc_idx >= 0)
-        {
-            CreatureLocale const* cl = sObjectMgr.GetCreatureLocale (id);
-            if (cl)
-            {
-                if (cl->Name.size() > uint32(loc_idx) && !cl->Name[loc_idx].empty ())
-                {
-                    std::string name = cl->Name[loc_idx];
-
-                    if (Utf8FitTo (name, wnamepart))
-                    {
-                        if (maxResults && count++ == maxResults)
-                        {
-                            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                            return true;
-                        }
-
-                        if (m_session)
-                            PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CHAT, id, id, name.c_str ());
-                        else
-                            PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CONSOLE, id, name.c_str ());
-
-                        if (!found)
-                            found = true;
+    int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
+    LookupNames const& names = sLookupIndex.GetNames(LOOKUP_CREATURE, -1);
+    LookupNames const* locNames = loc_idx >= 0 ? &sLookupIndex.GetNames(LOOKUP_CREATURE, loc_idx) : NULL;
 
-                        continue;
-                    }
-                }
-            }
-        }
+    for (size_t i = 0; i < names.Ids.size(); ++i)
+    {
+        uint32 id = names.Ids[i];
+        std::string name;
 
-        std::string name = cInfo->Name;
-        if (name.empty ())
+        if (locNames && locNames->Fits(i, wnamepart))
+            name = sObjectMgr.GetCreatureLocale(id)->Name[loc_idx];
+        else if (names.Fits(i, wnamepart))
+            name = sCreatureStorage.LookupEntry<CreatureInfo>(id)->Name;
+        else
             continue;
 
-        if (Utf8FitTo(name, wnamepart))
+        if (maxResults && count++ == maxResults)
         {
-            if (maxResults && count++ == maxResults)
-            {
-                PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                return true;
-            }
+            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
+            return true;
+        }
 
-            if (m_session)
-                PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CHAT, id, id, name.c_str ());
-            else
-                PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CONSOLE, id, name.c_str ());
+        if (m_session)
+            PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CHAT, id, id, name.c_str ());
+        else
+            PSendSysMessage (LANG_CREATURE_ENTRY_LIST_CONSOLE, id, name.c_str ());
 
-            if (!found)
-                found = true;
-        }
+        if (!found)
+            found = true;
     }
 
     if (!found)
@@ -3672,64 +3575,35 @@ bool ChatHandler::HandleLookupObjectCommand(const char* args)
     uint32 count = 0;
     uint32 maxResults = sWorld.getConfig(CONFIG_MAX_RESULTS_LOOKUP_COMMANDS);
 
-    for (uint32 id = 0; id < sGOStorage.MaxEntry; id++)
-    {
-        GameObjectInfo const* gInfo = sGOStorage.LookupEntry<GameObjectInfo>(id);
-        if (!gInfo)
-            continue;
-
-        int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
-        if (loc_idx >= 0)
-        {
-            GameObjectLocale const* gl = sObjectMgr.GetGameObjectLocale(id);
-            if (gl)
-            {
-                if (gl->Name.size() > uint32(loc_idx) && !gl->Name[loc_idx].empty())
-                {
-                    std::string name = gl->Name[loc_idx];
-
-                    if (Utf8FitTo(name, wnamepart))
-                    {
-                        if (maxResults && count++ == maxResults)
-                        {
-                            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                            return true;
-                        }
-
-                        if (m_session)
-                            PSendSysMessage(LANG_GO_ENTRY_LIST_CHAT, id, id, name.c_str());
-                        else
-                            PSendSysMessage(LANG_GO_ENTRY_LIST_CONSOLE, id, name.c_str());
+    int loc_idx = m_session ? m_session->GetSessionDbLocaleIndex() : sObjectMgr.GetDBCLocaleIndex();
+    LookupNames const& names = sLookupIndex.GetNames(LOOKUP_GAMEOBJECT, -1);
+    LookupNames const* locNames = loc_idx >= 0 ? &sLookupIndex.GetNames(LOOKUP_GAMEOBJECT, loc_idx) : NULL;
 
-                        if (!found)
-                            found = true;
-
-                        continue;
-                    }
-                }
-            }
-        }
+    for (size_t i = 0; i < names.Ids.size(); ++i)
+    {
+        uint32 id = names.Ids[i];
+        std::string name;
 
-        std::string name = gInfo->name;
-        if (name.empty())
+        if (locNames && locNames->Fits(i, wnamepart))
+            name = sObjectMgr.GetGameObjectLocale(id)->Name[loc_idx];
+        else if (names.Fits(i, wnamepart))
+            name = sGOStorage.LookupEntry<GameObjectInfo>(id)->name;
+        else
             continue;
 
-        if (Utf8FitTo(name, wnamepart))
+        if (maxResults && count++ == maxResults)
         {
-            if (maxResults && count++ == maxResults)
-            {
-                PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
-                return true;
-            }
+            PSendSysMessage(LANG_COMMAND_LOOKUP_MAX_RESULTS, maxResults);
+            return true;
+        }
 
-            if (m_session)
-                PSendSysMessage(LANG_GO_ENTRY_LIST_CHAT, id, id, name.c_str());
-            else
-                PSendSysMessage(LANG_GO_ENTRY_LIST_CONSOLE, id, name.c_str());
+        if (m_session)
+            PSendSysMessage(LANG_GO_ENTRY_LIST_CHAT, id, id, name.c_str());
+        else
+            PSendSysMessage(LANG_GO_ENTRY_LIST_CONSOLE, id, name.c_str());
 
-            if (!found)
-                found = true;
-        }
+        if (!found)
+            found = true;
     }
 
     if (!found)
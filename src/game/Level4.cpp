@@ -12,6 +12,7 @@
 #include "MapManager.h"
 #include "Player.h"
 #include "Util.h"
+#include "TickProfiler.h"
 
 // Delete a user account and all associated characters in this realm
 // todo - This function has to be enhanced to respect the login/realm split (delete char, delete account chars in realm, delete account chars in realm then delete account
@@ -582,3 +583,57 @@ bool ChatHandler::HandleServerSetDiffTimeCommand(const char* args)
     return true;
 }
 
+// record world ticks with the tick profiler, optionally for a number of ticks only
+bool ChatHandler::HandleServerProfileStartCommand(const char* args)
+{
+    int32 ticks = *args ? atoi(args) : 0;
+    if (ticks < 0)
+        return false;
+
+    if (sTickProfiler.IsRecording())
+    {
+        SendSysMessage("The tick profiler is already running.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    sTickProfiler.RequestStart(uint32(ticks));
+    if (ticks)
+        PSendSysMessage("Tick profiler will record the next %i world ticks.", ticks);
+    else
+        SendSysMessage("Tick profiler started, use .server profile stop to write the results.");
+    return true;
+}
+
+bool ChatHandler::HandleServerProfileStopCommand(const char* /*args*/)
+{
+    if (!sTickProfiler.IsRecording())
+    {
+        SendSysMessage("The tick profiler is not running.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    sTickProfiler.RequestStop();
+    SendSysMessage("Tick profiler stopped, the trace is written to the logs directory.");
+    return true;
+}
+
+// packets of protected opcodes dropped by the network threads since startup
+bool ChatHandler::HandleServerThrottleCommand(const char* /*args*/)
+{
+    uint32 count = sWorld.GetProtectedOpcodeCount();
+    if (!count)
+    {
+        SendSysMessage("No opcode is protected, see the opcode_protection table.");
+        return true;
+    }
+
+    for (uint32 slot = 0; slot < count; ++slot)
+    {
+        ProtectedOpcodeProperties const& prop = sWorld.GetProtectedOpcodeProperties(slot);
+        PSendSysMessage("%s: %u per %u ms, %li dropped, %li kicked", LookupOpcodeName(prop.opcode), prop.threshold, prop.interval,
+                        sWorld.GetThrottledPackets(slot), sWorld.GetThrottleKicks(slot));
+    }
+    return true;
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the OregonCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LookupIndex.h"
+#include "ObjectMgr.h"
+#include "DBCStores.h"
+#include "Util.h"
+
+INSTANTIATE_SINGLETON_1(LookupIndex);
+
+LookupNames const& LookupIndex::GetNames(LookupStore store, int loc)
+{
+    std::map<int, LookupNames>::iterator itr = m_names[store].find(loc);
+    if (itr != m_names[store].end())
+        return itr->second;
+
+    LookupNames& names = m_names[store][loc];
+    Build(store, loc, names);
+    return names;
+}
+
+void LookupIndex::AddName(LookupNames& names, uint32 id, const std::string& name)
+{
+    names.Ids.push_back(id);
+    names.Names.push_back(std::wstring());
+
+    // names that are no valid utf8 can't match, same as with Utf8FitTo
+    std::wstring& wname = names.Names.back();
+    if (!name.empty() && Utf8toWStr(name, wname))
+        wstrToLower(wname);
+    else
+        wname.clear();
+}
+
+void LookupIndex::Build(LookupStore store, int loc, LookupNames& names)
+{
+    static std::string const emptyName;
+
+    switch (store)
+    {
+        case LOOKUP_ITEM:
+            for (uint32 id = 0; id < sItemStorage.MaxEntry; ++id)
+            {
+                ItemTemplate const* pProto = sItemStorage.LookupEntry<ItemTemplate>(id);
+                if (!pProto)
+                    continue;
+
+                if (loc < 0)
+                    AddName(names, id, pProto->Name1);
+                else
+                {
+                    ItemLocale const* il = sObjectMgr.GetItemLocale(id);
+                    AddName(names, id, il && il->Name.size() > uint32(loc) ? il->Name[loc] : emptyName);
+                }
+            }
+            break;
+        case LOOKUP_CREATURE:
+            for (uint32 id = 0; id < sCreatureStorage.MaxEntry; ++id)
+            {
+                CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo>(id);
+                if (!cInfo)
+                    continue;
+
+                if (loc < 0)
+                    AddName(names, id, cInfo->Name);
+                else
+                {
+                    CreatureLocale const* cl = sObjectMgr.GetCreatureLocale(id);
+                    AddName(names, id, cl && cl->Name.size() > uint32(loc) ? cl->Name[loc] : emptyName);
+                }
+            }
+            break;
+        case LOOKUP_GAMEOBJECT:
+            for (uint32 id = 0; id < sGOStorage.MaxEntry; ++id)
+            {
+                GameObjectInfo const* gInfo = sGOStorage.LookupEntry<GameObjectInfo>(id);
+                if (!gInfo)
+                    continue;
+
+                if (loc < 0)
+                    AddName(names, id, gInfo->name);
+                else
+                {
+                    GameObjectLocale const* gl = sObjectMgr.GetGameObjectLocale(id);
+                    AddName(names, id, gl && gl->Name.size() > uint32(loc) ? gl->Name[loc] : emptyName);
+                }
+            }
+            break;
+        case LOOKUP_QUEST:
+        {
+            // the quest map is unordered, sort the ids so every locale has the same order
+            ObjectMgr::QuestMap const& qTemplates = sObjectMgr.GetQuestTemplates();
+            std::vector<uint32> ids;
+            ids.reserve(qTemplates.size());
+            for (ObjectMgr::QuestMap::const_iterator itr = qTemplates.begin(); itr != qTemplates.end(); ++itr)
+                ids.push_back(itr->first);
+            std::sort(ids.begin(), ids.end());
+
+            for (std::vector<uint32>::const_iterator itr = ids.begin(); itr != ids.end(); ++itr)
+            {
+                if (loc < 0)
+                    AddName(names, *itr, sObjectMgr.GetQuestTemplate(*itr)->GetTitle());
+                else
+                {
+                    QuestLocale const* ql = sObjectMgr.GetQuestLocale(*itr);
+                    AddName(names, *itr, ql && ql->Title.size() > uint32(loc) ? ql->Title[loc] : emptyName);
+                }
+            }
+            break;
+        }
+        case LOOKUP_SPELL:
+            for (uint32 id = 0; id < sSpellStore.GetNumRows(); ++id)
+            {
+                SpellEntry const* spellInfo = sSpellStore.LookupEntry(id);
+                if (!spellInfo)
+                    continue;
+
+                const char* name = spellInfo->SpellName[loc];
+                AddName(names, id, name ? name : emptyName);
+            }
+            break;
+        default:
+            break;
+    }
+}
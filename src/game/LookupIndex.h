@@ -0,0 +1,66 @@
+/*
+ * This file is part of the OregonCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OREGON_LOOKUPINDEX_H
+#define OREGON_LOOKUPINDEX_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+enum LookupStore
+{
+    LOOKUP_ITEM,
+    LOOKUP_CREATURE,
+    LOOKUP_GAMEOBJECT,
+    LOOKUP_QUEST,
+    LOOKUP_SPELL,
+    MAX_LOOKUP_STORES
+};
+
+// names of all entries of a store in one locale, converted for the .lookup commands
+struct LookupNames
+{
+    std::vector<uint32> Ids;                                // same order in every locale of a store
+    std::vector<std::wstring> Names;                        // lowercase, empty if the entry has no name in the locale
+
+    bool Fits(size_t i, const std::wstring& search) const
+    {
+        return !Names[i].empty() && Names[i].find(search) != std::wstring::npos;
+    }
+};
+
+// Lowercase wide names for the .lookup commands, so a lookup doesn't convert the
+// whole store again. Each locale is built on its first lookup and dropped on reload.
+class LookupIndex
+{
+    public:
+        // loc is the db locale index, -1 for the default names; spells use the dbc locale
+        LookupNames const& GetNames(LookupStore store, int loc);
+
+        // call after the store or its locales were reloaded
+        void Clear(LookupStore store) { m_names[store].clear(); }
+
+    private:
+        void Build(LookupStore store, int loc, LookupNames& names);
+        static void AddName(LookupNames& names, uint32 id, const std::string& name);
+
+        std::map<int, LookupNames> m_names[MAX_LOOKUP_STORES];
+};
+
+#define sLookupIndex Oregon::Singleton<LookupIndex>::Instance()
+
+#endif
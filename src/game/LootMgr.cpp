@@ -22,6 +22,8 @@
 #include "Util.h"
 #include "SharedDefines.h"
 
+#include <algorithm>
+
 static Rates const qualityToRate[MAX_ITEM_QUALITY] =
 {
     RATE_DROP_ITEM_POOR,                                    // ITEM_QUALITY_POOR
@@ -64,6 +66,7 @@ class LootTemplate::LootGroup                               // A set of loot def
     private:
         LootStoreItemList ExplicitlyChanced;                // Entries with chances defined in DB
         LootStoreItemList EqualChanced;                     // Zero chances - every entry takes the same chance
+        std::vector<float> ExplicitlyChancedSums;           // Running chance totals of ExplicitlyChanced, searched by Roll()
 
         LootStoreItem const* Roll() const;                  // Rolls an item from the group, returns NULL if all miss their chances
 };
@@ -934,7 +937,10 @@ ByteBuffer& operator<<(ByteBuffer& b, LootView const& lv)
 void LootTemplate::LootGroup::AddEntry(LootStoreItem& item)
 {
     if (item.chance != 0)
+    {
         ExplicitlyChanced.push_back(item);
+        ExplicitlyChancedSums.push_back((ExplicitlyChancedSums.empty() ? 0.0f : ExplicitlyChancedSums.back()) + item.chance);
+    }
     else
         EqualChanced.push_back(item);
 }
@@ -946,15 +952,10 @@ LootStoreItem const* LootTemplate::LootGroup::Roll() const
     {
         float roll = (float)rand_chance();
 
-        for (uint32 i = 0; i < ExplicitlyChanced.size(); ++i) //check each explicitly chanced entry in the template and modify its chance based on quality.
-        {
-            if (ExplicitlyChanced[i].chance >= 100.f)
-                return &ExplicitlyChanced[i];
-
-            roll -= ExplicitlyChanced[i].chance;
-            if (roll < 0)
-                return &ExplicitlyChanced[i];
-        }
+        // the first entry whose running chance total exceeds the roll takes it
+        std::vector<float>::const_iterator itr = std::upper_bound(ExplicitlyChancedSums.begin(), ExplicitlyChancedSums.end(), roll);
+        if (itr != ExplicitlyChancedSums.end())
+            return &ExplicitlyChanced[itr - ExplicitlyChancedSums.begin()];
     }
     if (!EqualChanced.empty())                              // If nothing selected yet - an item is taken from equal-chanced part
         return &EqualChanced[irand(0, EqualChanced.size() - 1)];
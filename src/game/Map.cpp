@@ -30,6 +30,8 @@
 #include "ObjectMgr.h"
 #include "DynamicTree.h"
 #include "MoveMap.h"
+#include "Battleground.h"
+#include "TickProfiler.h"
 
 #define DEFAULT_GRID_EXPIRY     300
 #define MAX_GRID_LOAD_TIME      50
@@ -204,7 +206,7 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _par
     m_unloadTimer(0), m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
     m_VisibilityNotifyPeriod(DEFAULT_VISIBILITY_NOTIFY_PERIOD),
     m_activeNonPlayersIter(m_activeNonPlayers.end()), i_gridExpiry(expiry),
-    i_scriptLock(false)
+    m_relocatedCreatures(0), m_relocationPairs(0), m_movementRelayTimer(0), i_scriptLock(false)
 {
     m_parentMap = (_parent ? _parent : this);
 
@@ -390,6 +392,53 @@ void Map::LoadGrid(float x, float y)
     EnsureGridLoaded(Cell(x, y));
 }
 
+// Queue a grid for loading before anyone enters it, so the cost of
+// populating it is paid in a later update instead of as a hitch
+void Map::PreloadGrid(float x, float y)
+{
+    if (!sWorld.getConfig(CONFIG_GRID_PRELOAD) || !Oregon::IsValidMapCoord(x, y))
+        return;
+
+    GridCoord p = Oregon::ComputeGridCoord(x, y);
+    if (IsGridLoaded(p))
+        return;
+
+    for (std::list<GridCoord>::const_iterator itr = i_gridsToPreload.begin(); itr != i_gridsToPreload.end(); ++itr)
+        if (*itr == p)
+            return;
+
+    i_gridsToPreload.push_back(p);
+}
+
+void Map::ProcessGridPreloads()
+{
+    uint32 count = 0;
+    while (!i_gridsToPreload.empty() && count < sWorld.getConfig(CONFIG_GRID_PRELOAD))
+    {
+        GridCoord p = i_gridsToPreload.front();
+        i_gridsToPreload.pop_front();
+
+        if (IsGridLoaded(p))
+            continue;
+
+        Cell cell(p.x_coord * MAX_NUMBER_OF_CELLS, p.y_coord * MAX_NUMBER_OF_CELLS);
+        sLog.outMap("Preloading grid[%u,%u] for map %u instance %u", p.x_coord, p.y_coord, GetId(), i_InstanceId);
+        EnsureGridLoaded(cell);
+        ++count;
+    }
+}
+
+// Free flying players cross grids faster than any other unit,
+// look one grid ahead in the direction they are heading
+void Map::PreloadGridAhead(Player* player)
+{
+    if (!player->IsFlying() && !player->HasUnitMovementFlag(MOVEMENTFLAG_FLYING2))
+        return;
+
+    float angle = player->GetOrientation();
+    PreloadGrid(player->GetPositionX() + SIZE_OF_GRIDS * cos(angle), player->GetPositionY() + SIZE_OF_GRIDS * sin(angle));
+}
+
 bool Map::AddPlayerToMap(Player* player)
 {
     // Check if we are adding to correct map
@@ -492,6 +541,11 @@ bool Map::IsGridLoaded(const GridCoord &p) const
 
 void Map::Update(const uint32& t_diff)
 {
+    PROFILE_ZONE("Map::Update");
+
+    if (!m_movementHeartbeats.empty())
+        RelayMovementHeartbeats(t_diff);
+
     m_dyn_tree.update(t_diff);
 
     // update active cells around players and active objects
@@ -570,6 +624,73 @@ void Map::Update(const uint32& t_diff)
 
     if (!m_mapRefManager.isEmpty() || !m_activeNonPlayers.empty())
         ProcessRelocationNotifies(t_diff);
+
+    if (!i_gridsToPreload.empty())
+        ProcessGridPreloads();
+}
+
+void Map::QueueMovementHeartbeat(Unit* mover, WorldPacket const& data)
+{
+    MovementHeartbeat& heartbeat = m_movementHeartbeats[mover->GetGUID()];
+    heartbeat.packet = data;
+    heartbeat.pending = true;
+}
+
+void Map::CancelMovementHeartbeat(Unit* mover)
+{
+    MovementHeartbeatMap::iterator itr = m_movementHeartbeats.find(mover->GetGUID());
+    if (itr != m_movementHeartbeats.end())
+        itr->second.pending = false;
+}
+
+void Map::RelayMovementHeartbeats(uint32 diff)
+{
+    PROFILE_ZONE("Map::RelayMovementHeartbeats");
+
+    m_movementRelayTimer += diff;
+    if (m_movementRelayTimer < sWorld.getConfig(CONFIG_MOVEMENT_RELAY_INTERVAL))
+        return;
+    m_movementRelayTimer = 0;
+
+    float lodDistance = float(sWorld.getConfig(CONFIG_MOVEMENT_RELAY_LOD_DISTANCE));
+    uint32 lodInterval = sWorld.getConfig(CONFIG_MOVEMENT_RELAY_LOD_INTERVAL);
+    uint32 now = getMSTime();
+
+    for (MovementHeartbeatMap::iterator itr = m_movementHeartbeats.begin(); itr != m_movementHeartbeats.end();)
+    {
+        MovementHeartbeat& heartbeat = itr->second;
+        bool farDue = getMSTimeDiff(heartbeat.lastFarRelay, now) >= lodInterval;
+
+        // the entry is only kept to remember the last far relay, drop it once that doesn't matter anymore
+        if (!heartbeat.pending)
+        {
+            if (farDue)
+                m_movementHeartbeats.erase(itr++);
+            else
+                ++itr;
+            continue;
+        }
+
+        // mover may have logged out or left the map since the packet was queued
+        Unit* mover = ObjectAccessor::GetObjectInMap(itr->first, this, (Unit*)NULL);
+        if (!mover)
+        {
+            m_movementHeartbeats.erase(itr++);
+            continue;
+        }
+
+        heartbeat.pending = false;
+
+        Unit* source = mover->isCharmed() && mover->GetCharmer() ? mover->GetCharmer() : mover;
+        float distance = source->GetVisibilityRange();
+        if (farDue || lodDistance <= 0.0f || lodDistance >= distance)
+            heartbeat.lastFarRelay = now;
+        else
+            distance = lodDistance;
+
+        source->SendMessageToSetInRange(&heartbeat.packet, distance, false);
+        ++itr;
+    }
 }
 
 struct ResetNotifier
@@ -590,8 +711,25 @@ struct ResetNotifier
     }
 };
 
+static void ProcessCreatureRelocationBatch(Oregon::CreatureRelocationBatch& batch, CellCoord const& cell, std::vector<Oregon::RelocatedCreature>& creatures)
+{
+    if (creatures.empty())
+        return;
+
+    std::sort(creatures.begin(), creatures.end());
+    batch.Process(cell, creatures);
+}
+
 void Map::ProcessRelocationNotifies(const uint32& diff)
 {
+    PROFILE_ZONE("Map::ProcessRelocationNotifies");
+
+    float monsterSightRadius = (float)sWorld.getConfig(CONFIG_SIGHT_MONSTER);
+    std::vector<Oregon::RelocatedCreature> relocatedCreatures;
+    Oregon::CreatureRelocationBatch creatureRelocation(*this);
+    uint32 relocatedCount = 0;
+    bool anyGridDue = false;
+
     for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end(); ++i)
     {
         NGridType* grid = i->GetSource();
@@ -603,8 +741,8 @@ void Map::ProcessRelocationNotifies(const uint32& diff)
         if (!grid->getGridInfoRef()->getRelocationTimer().TPassed())
             continue;
 
+        anyGridDue = true;
         uint32 gx = grid->getX(), gy = grid->getY();
-        float monsterSightRadius = (float)sWorld.getConfig(CONFIG_SIGHT_MONSTER);
 
         CellCoord cell_min(gx * MAX_NUMBER_OF_CELLS, gy * MAX_NUMBER_OF_CELLS);
         CellCoord cell_max(cell_min.x_coord + MAX_NUMBER_OF_CELLS, cell_min.y_coord + MAX_NUMBER_OF_CELLS);
@@ -621,16 +759,36 @@ void Map::ProcessRelocationNotifies(const uint32& diff)
                 Cell cell(pair);
                 cell.SetNoCreate();
 
-                Oregon::DelayedUnitRelocation cell_relocationCreature(cell, pair, *this, monsterSightRadius);
+                // creatures moved in the cell are notified in batches of the same radius, pets and
+                // active creatures of the world container keep the wider radius they were always
+                // checked with and must not widen the gathering of the others
+                relocatedCreatures.clear();
+                Oregon::RelocatedCreatureCollector grid_collector(relocatedCreatures, monsterSightRadius);
+                TypeContainerVisitor<Oregon::RelocatedCreatureCollector, GridTypeMapContainer  > grid_creature_collector(grid_collector);
+                Visit(cell, grid_creature_collector);
+                ProcessCreatureRelocationBatch(creatureRelocation, pair, relocatedCreatures);
+                relocatedCount += relocatedCreatures.size();
+
+                relocatedCreatures.clear();
+                Oregon::RelocatedCreatureCollector world_collector(relocatedCreatures, MAX_VISIBILITY_DISTANCE);
+                TypeContainerVisitor<Oregon::RelocatedCreatureCollector, WorldTypeMapContainer > world_creature_collector(world_collector);
+                Visit(cell, world_creature_collector);
+                ProcessCreatureRelocationBatch(creatureRelocation, pair, relocatedCreatures);
+                relocatedCount += relocatedCreatures.size();
+
                 Oregon::DelayedUnitRelocation cell_relocationPlayer(cell, pair, *this, MAX_VISIBILITY_DISTANCE);
-                TypeContainerVisitor<Oregon::DelayedUnitRelocation, GridTypeMapContainer  > grid_object_relocation(cell_relocationCreature);
                 TypeContainerVisitor<Oregon::DelayedUnitRelocation, WorldTypeMapContainer > world_object_relocation(cell_relocationPlayer);
-                Visit(cell, grid_object_relocation);
                 Visit(cell, world_object_relocation);
             }
         }
     }
 
+    if (!anyGridDue)
+        return;
+
+    m_relocatedCreatures = relocatedCount;
+    m_relocationPairs = creatureRelocation.i_pairs;
+
     ResetNotifier reset;
     TypeContainerVisitor<ResetNotifier, GridTypeMapContainer >  grid_notifier(reset);
     TypeContainerVisitor<ResetNotifier, WorldTypeMapContainer > world_notifier(reset);
@@ -725,6 +883,8 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
             EnsureGridLoadedForActiveObject(new_cell, player);
 
         AddToGrid(player, new_cell);
+
+        PreloadGridAhead(player);
     }
 
     player->UpdateObjectVisibility(false);
@@ -2561,7 +2721,7 @@ void InstanceMap::SetResetSchedule(bool on)
 /* ******* Battleground Instance Maps ******* */
 
 BattlegroundMap::BattlegroundMap(uint32 id, time_t expiry, uint32 InstanceId, Map* _parent)
-    : Map(id, expiry, InstanceId, DIFFICULTY_NORMAL, _parent)
+    : Map(id, expiry, InstanceId, DIFFICULTY_NORMAL, _parent), m_bg(NULL)
 {
     //lets initialize visibility distance for BG/Arenas
     BattlegroundMap::InitVisibilityDistance();
@@ -2571,6 +2731,18 @@ BattlegroundMap::~BattlegroundMap()
 {
 }
 
+void BattlegroundMap::Update(const uint32& t_diff)
+{
+    Map::Update(t_diff);
+
+    // the battleground logic runs with its map, queue bookkeeping is handed to BattlegroundMgr
+    if (m_bg)
+    {
+        PROFILE_ZONE("Battleground::Update");
+        m_bg->Update(t_diff);
+    }
+}
+
 void BattlegroundMap::InitVisibilityDistance()
 {
     //init visibility distance for BG/Arenas
@@ -33,6 +33,8 @@
 
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
+#include "WorldPacket.h"
+#include "Utilities/UnorderedMap.h"
 
 #include <bitset>
 #include <list>
@@ -318,6 +320,7 @@ class Map : public GridRefManager<NGridType>, public Oregon::ObjectLevelLockable
             getNGrid(p.x_coord, p.y_coord)->setUnloadExplicitLock(on);
         }
         void LoadGrid(float x, float y);
+        void PreloadGrid(float x, float y);
         bool UnloadGrid(NGridType& ngrid, bool pForce);
         virtual void UnloadAll();
 
@@ -486,6 +489,17 @@ class Map : public GridRefManager<NGridType>, public Oregon::ObjectLevelLockable
 
         void SendToPlayers(WorldPacket const* data) const;
 
+        // creatures notified and unit pairs they were checked against in the last relocation pass
+        uint32 GetRelocatedCreatures() const { return m_relocatedCreatures; }
+        uint32 GetRelocationPairs() const { return m_relocationPairs; }
+
+        // MSG_MOVE_HEARTBEAT of mover, kept until the next relay and replaced by newer ones.
+        // Called from the session update on the world thread, never while maps update.
+        void QueueMovementHeartbeat(Unit* mover, WorldPacket const& data);
+        // drops the pending heartbeat of mover, done when a newer movement packet was relayed
+        // or the mover was moved by a teleport or knockback on this map
+        void CancelMovementHeartbeat(Unit* mover);
+
         typedef MapRefManager PlayerList;
         PlayerList const& GetPlayers() const
         {
@@ -559,6 +573,11 @@ class Map : public GridRefManager<NGridType>, public Oregon::ObjectLevelLockable
         void EnsureGridCreated(const GridCoord&);
         bool EnsureGridLoaded(Cell const&);
         void EnsureGridLoadedForActiveObject(Cell const&, WorldObject* object);
+        void ProcessGridPreloads();
+        void PreloadGridAhead(Player* player);
+
+        // grids expected to be entered soon, loaded a few per update
+        std::list<GridCoord> i_gridsToPreload;
 
         void buildNGridLinkage(NGridType* pNGridType)
         {
@@ -635,6 +654,22 @@ class Map : public GridRefManager<NGridType>, public Oregon::ObjectLevelLockable
         //these functions used to process player/mob aggro reactions and
         //visibility calculations. Highly optimized for massive calculations
         void ProcessRelocationNotifies(const uint32& diff);
+        uint32 m_relocatedCreatures;
+        uint32 m_relocationPairs;
+
+        void RelayMovementHeartbeats(uint32 diff);
+
+        struct MovementHeartbeat
+        {
+            MovementHeartbeat() : pending(false), lastFarRelay(0) {}
+
+            WorldPacket packet;
+            bool pending;
+            uint32 lastFarRelay;                            // last time it was sent beyond Movement.RelayLodDistance
+        };
+        typedef UNORDERED_MAP<uint64, MovementHeartbeat> MovementHeartbeatMap;
+        MovementHeartbeatMap m_movementHeartbeats;
+        uint32 m_movementRelayTimer;
 
         bool i_scriptLock;
         std::set<WorldObject*> i_objectsToRemove;
@@ -722,6 +757,8 @@ class BattlegroundMap : public Map
         BattlegroundMap(uint32 id, time_t, uint32 InstanceId, Map* _parent);
         ~BattlegroundMap() override;
 
+        void Update(const uint32&) override;
+
         bool AddPlayerToMap(Player*) override;
         void RemovePlayerFromMap(Player*, bool) override;
         EnterState CannotEnter(Player* player) override;
@@ -26,6 +26,7 @@
 #include "World.h"
 #include "Corpse.h"
 #include "ObjectMgr.h"
+#include "TickProfiler.h"
 
 #define CLASS_LOCK Oregon::ClassLevelLockable<MapManager, ACE_Thread_Mutex>
 INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
@@ -224,6 +225,8 @@ Map::EnterState MapManager::PlayerCannotEnter(uint32 mapid, Player* player, bool
 
 void MapManager::Update(time_t diff)
 {
+    PROFILE_ZONE("MapManager::Update");
+
     i_timer.Update(diff);
     if (!i_timer.Passed())
         return;
@@ -125,6 +125,13 @@ bool MMapManager::loadMapData(uint32 mapId)
                 ASSERT(false && "Invalid mapId passed to MMapManager after startup in thread unsafe environment");
         }
 
+    // a packed archive is preferred over the .mmap and .mmtile files
+    if (MMapData* mmap_data = loadMapArchive(mapId))
+    {
+        itr->second = mmap_data;
+        return true;
+    }
+
     // load and init dtNavMesh - read parameters from file
     uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i.mmap") + 1;
     char* fileName = new char[pathLen];
@@ -164,6 +171,69 @@ bool MMapManager::loadMapData(uint32 mapId)
     return true;
 }
 
+MMapData* MMapManager::loadMapArchive(uint32 mapId)
+{
+    uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i.mmpak") + 1;
+    char* fileName = new char[pathLen];
+    snprintf(fileName, pathLen, (sWorld.GetDataPath() + "mmaps/%03i.mmpak").c_str(), mapId);
+
+    // private mapping: detour writes links into the tile data it is given,
+    // only the pages it touches get copied, the rest stays in the shared page cache
+    ACE_Mem_Map* archive = new ACE_Mem_Map();
+    if (archive->map(fileName, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_RDWR, ACE_MAP_PRIVATE) == -1)
+    {
+        sLog.outMMap("MMAP:loadMapArchive: Could not map mmap archive '%s'", fileName);
+        delete archive;
+        delete [] fileName;
+        return NULL;
+    }
+
+    unsigned char* base = (unsigned char*)archive->addr();
+    size_t size = archive->size();
+
+    MmapArchiveHeader const* header = (MmapArchiveHeader const*)base;
+    if (size < sizeof(MmapArchiveHeader) || header->archiveMagic != MMAP_ARCHIVE_MAGIC ||
+        header->dtVersion != DT_NAVMESH_VERSION || header->mmapVersion != MMAP_VERSION ||
+        size < sizeof(MmapArchiveHeader) + header->tileCount * sizeof(MmapArchiveTile))
+    {
+        sLog.outError("MMAP:loadMapArchive: Bad header in mmap archive %s", fileName);
+        delete archive;
+        delete [] fileName;
+        return NULL;
+    }
+
+    dtNavMesh* mesh = dtAllocNavMesh();
+    ASSERT(mesh);
+    if (dtStatusFailed(mesh->init(&header->params)))
+    {
+        dtFreeNavMesh(mesh);
+        sLog.outError("MMAP:loadMapArchive: Failed to initialize dtNavMesh for mmap %03u from file %s", mapId, fileName);
+        delete archive;
+        delete [] fileName;
+        return NULL;
+    }
+
+    MMapData* mmap_data = new MMapData(mesh, archive);
+
+    MmapArchiveTile const* tiles = (MmapArchiveTile const*)(header + 1);
+    for (uint32 i = 0; i < header->tileCount; ++i)
+    {
+        if (tiles[i].offset % MMAP_ARCHIVE_ALIGNMENT || size_t(tiles[i].offset) + tiles[i].size > size)
+        {
+            sLog.outError("MMAP:loadMapArchive: Bad index entry for tile %03u%02u%02u in %s", mapId,
+                          tiles[i].tileId >> 16, tiles[i].tileId & 0x0000FFFF, fileName);
+            continue;
+        }
+
+        mmap_data->archiveTiles[tiles[i].tileId] = &tiles[i];
+    }
+
+    delete [] fileName;
+
+    sLog.outDetail("MMAP:loadMapArchive: Loaded %03i.mmpak with %u tiles", mapId, header->tileCount);
+    return mmap_data;
+}
+
 uint32 MMapManager::packTileID(int32 x, int32 y)
 {
     return uint32(x << 16 | y);
@@ -187,6 +257,31 @@ bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
         return false;
     }
 
+    if (mmap->archive)
+    {
+        MMapArchiveTileSet::const_iterator tile = mmap->archiveTiles.find(packedGridPos);
+        if (tile == mmap->archiveTiles.end())
+        {
+            sLog.outMMap("MMAP:loadMap: Could not find tile %03u%02i%02i in mmap archive", mapId, x, y);
+            return false;
+        }
+
+        unsigned char* data = (unsigned char*)mmap->archive->addr() + tile->second->offset;
+        dtTileRef tileRef = 0;
+
+        // the data stays owned by the mapped archive, detour must not free it on removeTile
+        if (dtStatusFailed(mmap->navMesh->addTile(data, tile->second->size, 0, 0, &tileRef)))
+        {
+            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i from mmap archive into navmesh", mapId, x, y);
+            return false;
+        }
+
+        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        ++loadedTiles;
+        sLog.outDetail("MMAP:loadMap: Loaded %03i[%02i,%02i] from mmap archive", mapId, x, y);
+        return true;
+    }
+
     // load this tile :: mmaps/MMMXXYY.mmtile
     uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile") + 1;
     char* fileName = new char[pathLen];
@@ -25,6 +25,8 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshQuery.h"
 
+#include <ace/Mem_Map.h>
+
 //  memory management
 inline void* dtCustomAlloc(int size, dtAllocHint /*hint*/)
 {
@@ -36,16 +38,19 @@ inline void dtCustomFree(void* ptr)
     delete [] (unsigned char*)ptr;
 }
 
+struct MmapArchiveTile;
+
 //  move map related classes
 namespace MMAP
 {
 typedef UNORDERED_MAP<uint32, dtTileRef> MMapTileSet;
 typedef UNORDERED_MAP<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+typedef UNORDERED_MAP<uint32, MmapArchiveTile const*> MMapArchiveTileSet;
 
 // dummy struct to hold map's mmap data
 struct MMapData
 {
-    MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+    MMapData(dtNavMesh* mesh, ACE_Mem_Map* archiveFile = NULL) : navMesh(mesh), archive(archiveFile) {}
     ~MMapData()
     {
         for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
@@ -53,10 +58,17 @@ struct MMapData
 
         if (navMesh)
             dtFreeNavMesh(navMesh);
+
+        // tiles loaded from the archive point into it, so it goes after the navmesh
+        delete archive;
     }
 
     dtNavMesh* navMesh;
 
+    // mapped .mmpak file, NULL when the tiles are loaded from .mmtile files
+    ACE_Mem_Map* archive;
+    MMapArchiveTileSet archiveTiles;    // maps [map grid coords] to the tile's archive index entry
+
     // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
     NavMeshQuerySet navMeshQueries;     // instanceId to query
     MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
@@ -93,6 +105,7 @@ class MMapManager
         }
     private:
         bool loadMapData(uint32 mapId);
+        MMapData* loadMapArchive(uint32 mapId);
         uint32 packTileID(int32 x, int32 y);
 
         MMapDataSet::const_iterator GetMMapData(uint32 mapId) const;
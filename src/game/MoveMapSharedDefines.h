@@ -36,6 +36,31 @@ struct MmapTileHeader
         mmapVersion(MMAP_VERSION), size(0), usesLiquids(true) {}
 };
 
+// .mmpak - all tiles of a map in one file, mapped into memory by the server
+// layout: MmapArchiveHeader, MmapArchiveTile[tileCount], tile data blobs each starting on MMAP_ARCHIVE_ALIGNMENT
+#define MMAP_ARCHIVE_MAGIC 0x4d4d504b   // 'MMPK'
+#define MMAP_ARCHIVE_ALIGNMENT 4096
+
+struct MmapArchiveHeader
+{
+    uint32 archiveMagic;
+    uint32 dtVersion;
+    uint32 mmapVersion;
+    uint32 tileCount;
+    dtNavMeshParams params;                                 // same as the .mmap file
+
+    MmapArchiveHeader() : archiveMagic(MMAP_ARCHIVE_MAGIC), dtVersion(DT_NAVMESH_VERSION),
+        mmapVersion(MMAP_VERSION), tileCount(0) {}
+};
+
+struct MmapArchiveTile
+{
+    uint32 tileId;                                          // x << 16 | y, as in the .mmtile file name
+    uint32 offset;                                          // from the start of the file
+    uint32 size;
+    uint32 usesLiquids;
+};
+
 enum NavTerrain
 {
     NAV_EMPTY   = 0x00,
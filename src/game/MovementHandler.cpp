@@ -222,6 +222,7 @@ void WorldSession::HandleMoveTeleportAck(WorldPacket& recv_data)
 
     WorldLocation const& dest = plMover->GetTeleportDest();
 
+    plMover->GetMap()->CancelMovementHeartbeat(plMover);
     plMover->SetPosition(dest, true);
 
     uint32 newzone = plMover->GetZoneId();
@@ -345,10 +346,17 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
     WorldPacket data(opcode, mover->GetPackGUID().size() + recv_data.size());
     data << mover->GetPackGUID();
     data.append(recv_data.contents(), recv_data.size());
-    if (mover->isCharmed() && mover->GetCharmer())
-        mover->GetCharmer()->SendMessageToSet(&data, false);
+    // heartbeats only refresh a position the observers already extrapolate, the map relays the latest one per interval
+    if (opcode == MSG_MOVE_HEARTBEAT && sWorld.getConfig(CONFIG_MOVEMENT_RELAY_INTERVAL))
+        mover->GetMap()->QueueMovementHeartbeat(mover, data);
     else
-        mover->SendMessageToSet(&data, false);
+    {
+        mover->GetMap()->CancelMovementHeartbeat(mover);
+        if (mover->isCharmed() && mover->GetCharmer())
+            mover->GetCharmer()->SendMessageToSet(&data, false);
+        else
+            mover->SendMessageToSet(&data, false);
+    }
 
     mover->m_movementInfo = movementInfo;
     mover->SetPosition(movementInfo.pos);
@@ -513,6 +521,9 @@ void WorldSession::HandleMoveKnockBackAck(WorldPacket& recv_data)
     // Save movement flags
     GetPlayer()->SetUnitMovementFlags(movementInfo.GetMovementFlags());
 
+    // the knockback supersedes a heartbeat still waiting for the relay
+    GetPlayer()->GetMap()->CancelMovementHeartbeat(GetPlayer());
+
     // Send packet
     WorldPacket data(MSG_MOVE_KNOCK_BACK, uint16(recv_data.size() + 4));
     data.appendPackGUID(guid);
@@ -1243,7 +1243,7 @@ void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
     //                                                       0              1   2    3
-    QueryResult_AutoPtr result = WorldDatabase.Query("SELECT creature.guid, id, map, modelid,"
+    StreamedQueryResult_AutoPtr result = WorldDatabase.StreamQuery("SELECT creature.guid, id, map, modelid,"
                                  //4             5           6           7           8            9              10         11
                                  "equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, spawndist, currentwaypoint,"
                                  //12        13       14            15         16     17
@@ -1486,7 +1486,7 @@ void ObjectMgr::LoadGameobjects()
     uint32 count = 0;
 
     //                                                       0                1   2    3           4           5           6
-    QueryResult_AutoPtr result = WorldDatabase.Query("SELECT gameobject.guid, id, map, position_x, position_y, position_z, orientation,"
+    StreamedQueryResult_AutoPtr result = WorldDatabase.StreamQuery("SELECT gameobject.guid, id, map, position_x, position_y, position_z, orientation,"
                                  //   7          8          9          10         11             12            13     14         15     16
                                  "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnMask, event, pool_entry "
                                  "FROM gameobject LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
@@ -1604,7 +1604,7 @@ void ObjectMgr::LoadCreatureRespawnTimes()
 {
     uint32 count = 0;
 
-    QueryResult_AutoPtr result = WorldDatabase.Query("SELECT guid,respawntime,instance FROM creature_respawn");
+    StreamedQueryResult_AutoPtr result = WorldDatabase.StreamQuery("SELECT guid,respawntime,instance FROM creature_respawn");
 
     if (!result)
     {
@@ -1639,7 +1639,7 @@ void ObjectMgr::LoadGameobjectRespawnTimes()
 
     uint32 count = 0;
 
-    QueryResult_AutoPtr result = WorldDatabase.Query("SELECT guid,respawntime,instance FROM gameobject_respawn");
+    StreamedQueryResult_AutoPtr result = WorldDatabase.StreamQuery("SELECT guid,respawntime,instance FROM gameobject_respawn");
 
     if (!result)
     {
@@ -4415,7 +4415,7 @@ void ObjectMgr::LoadGossipScripts()
 
 void ObjectMgr::LoadItemTexts()
 {
-    QueryResult_AutoPtr result = CharacterDatabase.Query("SELECT id, text FROM item_text");
+    StreamedQueryResult_AutoPtr result = CharacterDatabase.StreamQuery("SELECT id, text FROM item_text");
 
     uint32 count = 0;
 
@@ -6303,9 +6303,9 @@ void ObjectMgr::LoadWeatherZoneChances()
 void ObjectMgr::SaveCreatureRespawnTime(uint32 loguid, uint32 instance, time_t t)
 {
     mCreatureRespawnTimes[MAKE_PAIR64(loguid, instance)] = t;
-    WorldDatabase.PExecute("DELETE FROM creature_respawn WHERE guid = '%u' AND instance = '%u'", loguid, instance);
-    if (t)
-        WorldDatabase.PExecute("INSERT INTO creature_respawn VALUES ('%u', '" UI64FMTD "', '%u')", loguid, uint64(t), instance);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_RespawnTimesToSaveLock);
+    mCreatureRespawnTimesToSave[MAKE_PAIR64(loguid, instance)] = t;
 }
 
 void ObjectMgr::DeleteCreatureData(uint32 guid)
@@ -6321,37 +6321,102 @@ void ObjectMgr::DeleteCreatureData(uint32 guid)
 void ObjectMgr::SaveGORespawnTime(uint32 loguid, uint32 instance, time_t t)
 {
     mGORespawnTimes[MAKE_PAIR64(loguid, instance)] = t;
-    WorldDatabase.PExecute("DELETE FROM gameobject_respawn WHERE guid = '%u' AND instance = '%u'", loguid, instance);
-    if (t)
-        WorldDatabase.PExecute("INSERT INTO gameobject_respawn VALUES ('%u', '" UI64FMTD "', '%u')", loguid, uint64(t), instance);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_RespawnTimesToSaveLock);
+    mGORespawnTimesToSave[MAKE_PAIR64(loguid, instance)] = t;
 }
 
-void ObjectMgr::DeleteRespawnTimeForInstance(uint32 instance)
+static void EraseRespawnTimesForInstance(RespawnTimes& times, uint32 instance)
 {
     RespawnTimes::iterator next;
 
-    for (RespawnTimes::iterator itr = mGORespawnTimes.begin(); itr != mGORespawnTimes.end(); itr = next)
+    for (RespawnTimes::iterator itr = times.begin(); itr != times.end(); itr = next)
     {
         next = itr;
         ++next;
 
-        if (GUID_HIPART(itr->first) == instance)
-            mGORespawnTimes.erase(itr);
+        if (PAIR64_HIPART(itr->first) == instance)
+            times.erase(itr);
     }
+}
 
-    for (RespawnTimes::iterator itr = mCreatureRespawnTimes.begin(); itr != mCreatureRespawnTimes.end(); itr = next)
-    {
-        next = itr;
-        ++next;
+void ObjectMgr::DeleteRespawnTimeForInstance(uint32 instance)
+{
+    EraseRespawnTimesForInstance(mGORespawnTimes, instance);
+    EraseRespawnTimesForInstance(mCreatureRespawnTimes, instance);
 
-        if (GUID_HIPART(itr->first) == instance)
-            mCreatureRespawnTimes.erase(itr);
+    {
+        // pending changes must not bring rows of the instance back
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_RespawnTimesToSaveLock);
+        EraseRespawnTimesForInstance(mGORespawnTimesToSave, instance);
+        EraseRespawnTimesForInstance(mCreatureRespawnTimesToSave, instance);
     }
 
     WorldDatabase.PExecute("DELETE FROM creature_respawn WHERE instance = '%u'", instance);
     WorldDatabase.PExecute("DELETE FROM gameobject_respawn WHERE instance = '%u'", instance);
 }
 
+// rows per statement when writing collected respawn times
+#define RESPAWN_SAVE_BATCH_SIZE 500
+
+static void SaveRespawnTimesTo(char const* table, RespawnTimes const& times)
+{
+    // statements are built here and passed to Execute, PExecute would cut them at MAX_QUERY_LEN
+    std::ostringstream deleted, replaced;
+    uint32 deletedCount = 0, replacedCount = 0;
+
+    for (RespawnTimes::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+    {
+        uint32 loguid = PAIR64_LOPART(itr->first);
+        uint32 instance = PAIR64_HIPART(itr->first);
+
+        if (itr->second)
+        {
+            if (!replacedCount)
+                replaced << "REPLACE INTO " << table << " VALUES ";
+            replaced << (replacedCount ? "," : "") << "('" << loguid << "','" << uint64(itr->second) << "','" << instance << "')";
+            if (++replacedCount == RESPAWN_SAVE_BATCH_SIZE)
+            {
+                WorldDatabase.Execute(replaced.str().c_str());
+                replaced.str("");
+                replacedCount = 0;
+            }
+        }
+        else
+        {
+            if (!deletedCount)
+                deleted << "DELETE FROM " << table << " WHERE ";
+            deleted << (deletedCount ? " OR " : "") << "(guid = '" << loguid << "' AND instance = '" << instance << "')";
+            if (++deletedCount == RESPAWN_SAVE_BATCH_SIZE)
+            {
+                WorldDatabase.Execute(deleted.str().c_str());
+                deleted.str("");
+                deletedCount = 0;
+            }
+        }
+    }
+
+    if (replacedCount)
+        WorldDatabase.Execute(replaced.str().c_str());
+    if (deletedCount)
+        WorldDatabase.Execute(deleted.str().c_str());
+}
+
+// Writes respawn times changed since the last call, a few multi-row
+// statements instead of a DELETE and INSERT for every death
+void ObjectMgr::SaveRespawnTimes()
+{
+    RespawnTimes creatures, gameobjects;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_RespawnTimesToSaveLock);
+        creatures.swap(mCreatureRespawnTimesToSave);
+        gameobjects.swap(mGORespawnTimesToSave);
+    }
+
+    SaveRespawnTimesTo("creature_respawn", creatures);
+    SaveRespawnTimesTo("gameobject_respawn", gameobjects);
+}
+
 void ObjectMgr::DeleteGOData(uint32 guid)
 {
     // remove mapid*cellid -> guid_set map
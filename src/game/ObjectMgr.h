@@ -1052,6 +1052,7 @@ class ObjectMgr
         }
         void SaveGORespawnTime(uint32 loguid, uint32 instance, time_t t);
         void DeleteRespawnTimeForInstance(uint32 instance);
+        void SaveRespawnTimes();
 
         // grid objects
         void AddCreatureToGrid(uint32 guid, CreatureData const* data);
@@ -1284,6 +1285,11 @@ class ObjectMgr
         RespawnTimes mCreatureRespawnTimes;
         RespawnTimes mGORespawnTimes;
 
+        // respawn time changes not written to the DB yet, 0 means delete
+        RespawnTimes mCreatureRespawnTimesToSave;
+        RespawnTimes mGORespawnTimesToSave;
+        ACE_Thread_Mutex m_RespawnTimesToSaveLock;
+
         typedef std::vector<uint32> GuildBankTabPriceMap;
         GuildBankTabPriceMap mGuildBankTabPrice;
 
@@ -24,6 +24,7 @@
 #include "OutdoorPvPEP.h"
 #include "ObjectMgr.h"
 #include "Player.h"
+#include "TickProfiler.h"
 
 INSTANTIATE_SINGLETON_1(OutdoorPvPMgr);
 
@@ -167,6 +168,8 @@ OutdoorPvP* OutdoorPvPMgr::GetOutdoorPvPToZoneId(uint32 zoneid)
 
 void OutdoorPvPMgr::Update(uint32 diff)
 {
+    PROFILE_ZONE("OutdoorPvPMgr::Update");
+
     m_UpdateTimer += diff;
     if (m_UpdateTimer > OUTDOORPVP_OBJECTIVE_UPDATE_INTERVAL)
     {
@@ -64,6 +64,7 @@
 #include "ConditionMgr.h"
 #include "ScriptMgr.h"
 #include "PoolMgr.h"
+#include "TickProfiler.h"
 
 #include <cmath>
 
@@ -1042,6 +1043,8 @@ void Player::SetDrunkValue(uint16 newDrunkenValue, uint32 itemId)
 
 void Player::Update(uint32 p_time)
 {
+    PROFILE_ZONE("Player::Update");
+
 	if (!IsInWorld())
 		return;
 
@@ -1619,6 +1622,9 @@ bool Player::TeleportTo(uint32 mapid, float x, float y, float z, float orientati
 
 	if (GetMapId() == mapid && !m_transport)
 	{
+		// a heartbeat queued before the teleport would show the old position to the players around
+		GetMap()->CancelMovementHeartbeat(this);
+
 		//lets reset far teleport flag if it wasn't reset during chained teleports
 		SetSemaphoreTeleportFar(false);
 		//setup delayed teleport flag
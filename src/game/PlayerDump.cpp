@@ -202,13 +202,12 @@ void fixNULLfields(std::string& line)
     }
 }
 
-std::string CreateDumpString(char const* tableName, QueryResult_AutoPtr result)
+std::string CreateDumpString(char const* tableName, Field* fields, uint32 fieldCount)
 {
-    if (!tableName || !result) return "";
+    if (!tableName || !fields) return "";
     std::ostringstream ss;
     ss << "INSERT INTO " << _TABLE_SIM_ << tableName << _TABLE_SIM_ << " VALUES (";
-    Field* fields = result->Fetch();
-    for (uint32 i = 0; i < result->GetFieldCount(); ++i)
+    for (uint32 i = 0; i < fieldCount; ++i)
     {
         if (i == 0) ss << "'";
         else ss << ", '";
@@ -252,17 +251,15 @@ std::string PlayerDumpWriter::GenerateWhereStr(char const* field, GUIDs const& g
     return wherestr.str();
 }
 
-void StoreGUID(QueryResult_AutoPtr result, uint32 field, std::set<uint32>& guids)
+void StoreGUID(Field* fields, uint32 field, std::set<uint32>& guids)
 {
-    Field* fields = result->Fetch();
     uint32 guid = fields[field].GetUInt32();
     if (guid)
         guids.insert(guid);
 }
 
-void StoreGUID(QueryResult_AutoPtr result, uint32 data, uint32 field, std::set<uint32>& guids)
+void StoreGUID(Field* fields, uint32 data, uint32 field, std::set<uint32>& guids)
 {
-    Field* fields = result->Fetch();
     std::string dataStr = fields[data].GetCppString();
     uint32 guid = atoi(gettoknth(dataStr, field).c_str());
     if (guid)
@@ -326,37 +323,39 @@ void PlayerDumpWriter::DumpTable(std::string& dump, uint32 guid, char const* tab
         else                                                // not set case, get single guid string
             wherestr = GenerateWhereStr(fieldname, guid);
 
-        QueryResult_AutoPtr result = CharacterDatabase.PQuery("SELECT * FROM %s WHERE %s", tableFrom, wherestr.c_str());
+        StreamedQueryResult_AutoPtr result = CharacterDatabase.PStreamQuery("SELECT * FROM %s WHERE %s", tableFrom, wherestr.c_str());
         if (!result)
             return;
 
         do
         {
+            Field* fields = result->Fetch();
+
             // collect guids
             switch (type)
             {
             case DTT_INVENTORY:
-                StoreGUID(result, 3, items);
+                StoreGUID(fields, 3, items);
                 break;       // item guid collection
             case DTT_ITEM:
-                StoreGUID(result, 0, ITEM_FIELD_ITEM_TEXT_ID, texts);
+                StoreGUID(fields, 0, ITEM_FIELD_ITEM_TEXT_ID, texts);
                 break;
             // item text id collection
             case DTT_PET:
-                StoreGUID(result, 0, pets);
+                StoreGUID(fields, 0, pets);
                 break;       // pet guid collection
             case DTT_MAIL:
-                StoreGUID(result, 0, mails);            // mail id collection
-                StoreGUID(result, 6, texts);
+                StoreGUID(fields, 0, mails);            // mail id collection
+                StoreGUID(fields, 6, texts);
                 break;       // item text id collection
             case DTT_MAIL_ITEM:
-                StoreGUID(result, 1, items);
+                StoreGUID(fields, 1, items);
                 break;       // item guid collection
             default:
                 break;
             }
 
-            dump += CreateDumpString(tableTo, result);
+            dump += CreateDumpString(tableTo, fields, result->GetFieldCount());
             dump += "\n";
         }
         while (result->NextRow());
@@ -36,16 +36,17 @@ class SmartScript
 
         void OnInitialize(WorldObject* obj, AreaTriggerEntry const* at = NULL);
         void GetScript();
-        void FillScript(SmartAIEventList e, WorldObject* obj, AreaTriggerEntry const* at);
+        void FillScript(SmartAIProgram const* program, WorldObject* obj, AreaTriggerEntry const* at);
 
         void ProcessEventsFor(SMART_EVENT e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
-        void ProcessEvent(SmartScriptHolder& e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
-        bool CheckTimer(SmartScriptHolder const& e) const;
-        void RecalcTimer(SmartScriptHolder& e, uint32 min, uint32 max);
-        void UpdateTimer(SmartScriptHolder& e, uint32 const diff);
-        void InitTimer(SmartScriptHolder& e);
-        void ProcessAction(SmartScriptHolder& e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
-        void ProcessTimedAction(SmartScriptHolder& e, uint32 const& min, uint32 const& max, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
+        void ProcessEventIfConditionsMet(SmartEventState& state, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellEntry* spell, GameObject* gob);
+        void ProcessEvent(SmartEventState& state, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
+        bool CheckTimer(SmartEventState const& state) const;
+        void RecalcTimer(SmartEventState& state, uint32 min, uint32 max);
+        void UpdateTimer(SmartEventState& state, uint32 const diff);
+        void InitTimer(SmartEventState& state);
+        void ProcessAction(SmartEventState& state, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
+        void ProcessTimedAction(SmartEventState& state, uint32 const& min, uint32 const& max, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellEntry* spell = NULL, GameObject* gob = NULL);
         ObjectList* GetTargets(SmartScriptHolder const& e, Unit* invoker = NULL);
         ObjectList* GetWorldObjectsInDist(float dist);
         void InstallTemplate(SmartScriptHolder const& e);
@@ -233,7 +234,7 @@ class SmartScript
         }
 
         //TIMED_ACTIONLIST (script type 9 aka script9)
-        void SetScript9(SmartScriptHolder& e, uint32 entry);
+        void SetScript9(SmartScriptHolder const& e, uint32 entry);
         Unit* GetLastInvoker();
         ObjectGuid mLastInvoker;
         typedef UNORDERED_MAP<uint32, uint32> CounterMap;
@@ -259,10 +260,37 @@ class SmartScript
         bool IsInPhase(uint32 p) const { return ((1 << (mEventPhase - 1)) & p) != 0; }
         void SetPhase(uint32 p = 0) { mEventPhase = p; }
 
-        SmartAIEventList mEvents;
-        SmartAIEventList mInstallEvents;
-        SmartAIEventList mTimedActionList;
+        // shared script of the object, its events are the first mProgram->events.size() entries of mEvents
+        SmartAIProgram const* mProgram;
+        SmartEventStateList mEvents;
+        SmartEventStateList mInstallEvents;
+        SmartEventStateList mTimedActionList;
         bool isProcessingTimedActionList;
+
+        // non timed events of mProgram waiting for their cooldown, indices into mEvents
+        std::vector<uint32> mCooldownEvents;
+
+        // events created at run time (AI templates, timed events), owned by this script
+        std::list<SmartScriptHolder> mOwnedEvents;
+        SmartScriptHolder const* AddOwnedEvent(SmartScriptHolder const& e)
+        {
+            mOwnedEvents.push_back(e);
+            return &mOwnedEvents.back();
+        }
+
+        void RemoveOwnedEvent(SmartScriptHolder const* e)
+        {
+            for (std::list<SmartScriptHolder>::iterator i = mOwnedEvents.begin(); i != mOwnedEvents.end(); ++i)
+            {
+                if (&(*i) == e)
+                {
+                    mOwnedEvents.erase(i);
+                    return;
+                }
+            }
+        }
+
+        SmartEventState* FindLinkedEvent(uint32 link);
         Creature* me;
         ObjectGuid meOrigGUID;
         GameObject* go;
@@ -272,7 +300,7 @@ class SmartScript
         uint32 mEventPhase;
 
         uint32 mPathId;
-        SmartAIEventList mStoredEvents;
+        SmartEventStateList mStoredEvents;
         std::list<uint32>mRemIDs;
 
         uint32 mTextTimer;
@@ -287,11 +315,13 @@ class SmartScript
         {
             if (!mStoredEvents.empty())
             {
-                for (SmartAIEventList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
+                for (SmartEventStateList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
                 {
-                    if (i->event_id == id)
+                    if (i->holder->event_id == id)
                     {
+                        SmartScriptHolder const* e = i->holder;
                         mStoredEvents.erase(i);
+                        RemoveOwnedEvent(e);
                         return;
                     }
                 }
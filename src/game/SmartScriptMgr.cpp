@@ -102,7 +102,10 @@ void SmartAIMgr::LoadSmartAIFromDB()
     uint32 oldMSTime = getMSTime();
 
     for (uint8 i = 0; i < SMART_SCRIPT_TYPE_MAX; i++)
+    {
         mEventMap[i].clear();  //Drop Existing SmartAI List
+        mProgramMap[i].clear();
+    }
 
     QueryResult_AutoPtr result = WorldDatabase.Query("SELECT entryorguid, source_type, id, link, event_type, event_phase_mask, event_chance, event_flags, event_param1, event_param2, event_param3, event_param4, action_type, action_param1, action_param2, action_param3, action_param4, action_param5, action_param6, target_type, target_param1, target_param2, target_param3, target_x, target_y, target_z, target_o FROM smart_scripts ORDER BY entryorguid, source_type, id, link");
 
@@ -280,11 +283,92 @@ void SmartAIMgr::LoadSmartAIFromDB()
         }
     }
 
+    CompilePrograms();
+
     sLog.outString(">> Loaded %u SmartAI scripts in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
 
     UnLoadHelperStores();
 }
 
+void SmartAIProgram::Compile()
+{
+    typeIndex.clear();
+    timedEvents.clear();
+    memset(typeOffset, 0, sizeof(typeOffset));
+
+    // counting sort of the event indices by type
+    for (uint32 i = 0; i < events.size(); ++i)
+        ++typeOffset[events[i].GetEventType() + 1];
+
+    for (uint32 t = 1; t <= SMART_EVENT_END; ++t)
+        typeOffset[t] += typeOffset[t - 1];
+
+    typeIndex.resize(events.size());
+
+    std::vector<uint16> next(typeOffset, typeOffset + SMART_EVENT_END);
+    for (uint32 i = 0; i < events.size(); ++i)
+    {
+        typeIndex[next[events[i].GetEventType()]++] = uint16(i);
+
+        if (IsSmartTimedEvent(events[i].GetEventType()))
+            timedEvents.push_back(uint16(i));
+    }
+}
+
+void SmartAIMgr::CompilePrograms()
+{
+    for (uint8 i = 0; i < SMART_SCRIPT_TYPE_MAX; ++i)
+    {
+        for (SmartAIEventMap::iterator itr = mEventMap[i].begin(); itr != mEventMap[i].end(); ++itr)
+        {
+            SmartAIProgramVariants& variants = mProgramMap[i][itr->first];
+
+            if (i == SMART_SCRIPT_TYPE_TIMED_ACTIONLIST)
+            {
+                // the event type comes from the action starting the list
+                static const SMART_EVENT timerEvents[3] = { SMART_EVENT_UPDATE_OOC, SMART_EVENT_UPDATE_IC, SMART_EVENT_UPDATE };
+
+                variants.resize(3);
+                for (uint8 v = 0; v < 3; ++v)
+                {
+                    variants[v].events = itr->second;
+                    for (SmartAIEventList::iterator e = variants[v].events.begin(); e != variants[v].events.end(); ++e)
+                        e->event.type = timerEvents[v];
+                    variants[v].Compile();
+                }
+                continue;
+            }
+
+            bool perDifficulty = false;
+            for (SmartAIEventList::const_iterator e = itr->second.begin(); e != itr->second.end(); ++e)
+                if (e->event.event_flags & SMART_EVENT_FLAG_DIFFICULTY_ALL)
+                    perDifficulty = true;
+
+            variants.resize(perDifficulty ? SMART_AI_PROGRAM_VARIANTS : 1);
+            for (uint8 v = 0; v < variants.size(); ++v)
+            {
+                for (SmartAIEventList::const_iterator e = itr->second.begin(); e != itr->second.end(); ++e)
+                {
+                    #ifndef TRINITY_DEBUG
+                    if (e->event.event_flags & SMART_EVENT_FLAG_DEBUG_ONLY)
+                        continue;
+                    #endif
+
+                    //if has instance flag add only if in it
+                    if ((e->event.event_flags & SMART_EVENT_FLAG_DIFFICULTY_ALL) && !(v && ((1 << v) & e->event.event_flags)))
+                        continue;
+
+                    variants[v].events.push_back(*e);//NOTE: 'world(0)' events still get processed in ANY instance mode
+                }
+                variants[v].Compile();
+            }
+        }
+
+        // the programs keep their own copy
+        mEventMap[i].clear();
+    }
+}
+
 bool SmartAIMgr::IsTargetValid(SmartScriptHolder const& e)
 {
     if (std::abs(e.target.o) > 2 * float(M_PI))
@@ -1344,11 +1344,12 @@ enum SmartCastFlags
 };
 
 // one line in DB is one event
+// One event/action/target row, never changed once loaded.
+// The run time state of the event lives in SmartEventState.
 struct SmartScriptHolder
 {
     SmartScriptHolder() : entryOrGuid(0), source_type(SMART_SCRIPT_TYPE_CREATURE)
-        , event_id(0), link(0), event(), action(), target(), timer(0), active(false), runOnce(false)
-        , enableTimed(false) { }
+        , event_id(0), link(0), event(), action(), target() { }
 
     int32 entryOrGuid;
     SmartScriptType source_type;
@@ -1364,14 +1365,25 @@ struct SmartScriptHolder
     uint32 GetActionType() const { return (uint32)action.type; }
     uint32 GetTargetType() const { return (uint32)target.type; }
 
+    operator bool() const { return entryOrGuid != 0; }
+};
+
+// State of one event for one object using the script
+struct SmartEventState
+{
+    explicit SmartEventState(SmartScriptHolder const* e) : holder(e), timer(0), active(false), runOnce(false)
+        , enableTimed(false), scheduled(false) { }
+
+    SmartScriptHolder const* holder;
     uint32 timer;
     bool active;
     bool runOnce;
     bool enableTimed;
-
-    operator bool() const { return entryOrGuid != 0; }
+    bool scheduled;                                         // in SmartScript::mCooldownEvents
 };
 
+typedef std::vector<SmartEventState> SmartEventStateList;
+
 typedef UNORDERED_MAP<uint32, WayPoint*> WPPath;
 
 typedef std::list<WorldObject*> ObjectList;
@@ -1460,6 +1472,58 @@ typedef std::vector<SmartScriptHolder> SmartAIEventList;
 // all events for all entries / guids
 typedef UNORDERED_MAP<int32, SmartAIEventList> SmartAIEventMap;
 
+// events counted down by SmartScript::UpdateTimer every update, the others only use their timer as cooldown
+inline bool IsSmartTimedEvent(uint32 type)
+{
+    switch (type)
+    {
+        case SMART_EVENT_UPDATE:
+        case SMART_EVENT_UPDATE_OOC:
+        case SMART_EVENT_UPDATE_IC:
+        case SMART_EVENT_HEALT_PCT:
+        case SMART_EVENT_TARGET_HEALTH_PCT:
+        case SMART_EVENT_MANA_PCT:
+        case SMART_EVENT_TARGET_MANA_PCT:
+        case SMART_EVENT_RANGE:
+        case SMART_EVENT_VICTIM_CASTING:
+        case SMART_EVENT_FRIENDLY_HEALTH:
+        case SMART_EVENT_FRIENDLY_IS_CC:
+        case SMART_EVENT_FRIENDLY_MISSING_BUFF:
+        case SMART_EVENT_HAS_AURA:
+        case SMART_EVENT_TARGET_BUFFED:
+        case SMART_EVENT_IS_BEHIND_TARGET:
+        case SMART_EVENT_FRIENDLY_HEALTH_PCT:
+        case SMART_EVENT_DISTANCE_CREATURE:
+        case SMART_EVENT_DISTANCE_GAMEOBJECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The events of one entry / guid, built once at load and shared by every object
+// using it. Each object only keeps a SmartEventState per event.
+struct SmartAIProgram
+{
+    SmartAIProgram() { memset(typeOffset, 0, sizeof(typeOffset)); }
+
+    // sort the event indices by event type and collect the timed events
+    void Compile();
+
+    SmartAIEventList events;
+    std::vector<uint16> typeIndex;                          // event indices grouped by type, database order within a type
+    uint16 typeOffset[SMART_EVENT_END + 1];                 // events of type t are typeIndex[typeOffset[t]] .. typeIndex[typeOffset[t + 1] - 1]
+    std::vector<uint16> timedEvents;                        // see IsSmartTimedEvent
+};
+
+// Variant 0 is used outside of dungeons and by scripts without difficulty flags,
+// variant spawnMode + 1 inside dungeons.
+// Timed action lists have one variant per timer type (0 OOC, 1 IC, 2 always).
+#define SMART_AI_PROGRAM_VARIANTS 5
+
+typedef std::vector<SmartAIProgram> SmartAIProgramVariants;
+typedef UNORDERED_MAP<int32, SmartAIProgramVariants> SmartAIProgramMap;
+
 // Helper Stores
 typedef std::map<uint32 /*entry*/, std::pair<uint32 /*spellId*/, SpellEffIndex /*effIndex*/> > CacheSpellContainer;
 typedef std::pair<CacheSpellContainer::const_iterator, CacheSpellContainer::const_iterator> CacheSpellContainerBounds;
@@ -1479,16 +1543,16 @@ class SmartAIMgr
 
         void LoadSmartAIFromDB();
 
-        SmartAIEventList GetScript(int32 entry, SmartScriptType type)
+        SmartAIProgram const* GetScript(int32 entry, SmartScriptType type, uint32 variant = 0) const
         {
-            SmartAIEventList temp;
-            if (mEventMap[uint32(type)].find(entry) != mEventMap[uint32(type)].end())
-                return mEventMap[uint32(type)][entry];
+            SmartAIProgramMap::const_iterator itr = mProgramMap[uint32(type)].find(entry);
+            if (itr != mProgramMap[uint32(type)].end())
+                return &itr->second[variant < itr->second.size() ? variant : 0];
             else
             {
                 if (entry > 0)//first search is for guid (negative), do not drop error if not found
                     sLog.outError("SmartAIMgr::GetScript: Could not load Script for Entry %d ScriptType %u.", entry, uint32(type));
-                return temp;
+                return NULL;
             }
         }
 
@@ -1517,9 +1581,14 @@ class SmartAIMgr
         }
 
     private:
-        //event stores
+        //event stores, only used while loading
         SmartAIEventMap mEventMap[SMART_SCRIPT_TYPE_MAX];
 
+        // compiled scripts
+        SmartAIProgramMap mProgramMap[SMART_SCRIPT_TYPE_MAX];
+
+        void CompilePrograms();
+
         bool IsEventValid(SmartScriptHolder& e);
         bool IsTargetValid(SmartScriptHolder const& e);
 
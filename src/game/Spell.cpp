@@ -45,6 +45,7 @@
 #include "GameEventMgr.h"
 #include "DisableMgr.h"
 #include "ConditionMgr.h"
+#include "TickProfiler.h"
 
 #define SPELL_CHANNEL_UPDATE_INTERVAL (1*IN_MILLISECONDS)
 
@@ -2837,6 +2838,8 @@ void Spell::SendSpellCooldown()
 
 void Spell::update(uint32 difftime)
 {
+    PROFILE_ZONE("Spell::update");
+
     // update pointers based at it's GUIDs
     UpdatePointers();
 
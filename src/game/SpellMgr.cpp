@@ -388,7 +388,18 @@ int32 CompareAuraRanks(uint32 spellId_1, uint32 effIndex_1, uint32 spellId_2, ui
     else return diff;
 }
 
+static SpellSpecific CalculateSpellSpecific(uint32 spellId);
+static bool CalculatePositiveEffect(uint32 spellId, uint32 effIndex);
+
 SpellSpecific GetSpellSpecific(uint32 spellId)
+{
+    if (SpellInfoEntry const* info = sSpellMgr.GetSpellInfo(spellId))
+        return SpellSpecific(info->specific);
+
+    return CalculateSpellSpecific(spellId);
+}
+
+static SpellSpecific CalculateSpellSpecific(uint32 spellId)
 {
     SpellEntry const* spellInfo = sSpellStore.LookupEntry(spellId);
     if (!spellInfo)
@@ -554,6 +565,14 @@ bool IsPositiveTarget(uint32 targetA, uint32 targetB)
 }
 
 bool IsPositiveEffect(uint32 spellId, uint32 effIndex)
+{
+    if (SpellInfoEntry const* info = sSpellMgr.GetSpellInfo(spellId))
+        return (info->flags & (SPELL_INFO_POSITIVE_EFFECT0 << effIndex)) != 0;
+
+    return CalculatePositiveEffect(spellId, effIndex);
+}
+
+static bool CalculatePositiveEffect(uint32 spellId, uint32 effIndex)
 {
     SpellEntry const* spellproto = sSpellStore.LookupEntry(spellId);
     if (!spellproto)
@@ -767,6 +786,9 @@ bool IsPositiveEffect(uint32 spellId, uint32 effIndex)
 
 bool IsPositiveSpell(uint32 spellId)
 {
+    if (SpellInfoEntry const* info = sSpellMgr.GetSpellInfo(spellId))
+        return (info->flags & SPELL_INFO_POSITIVE) != 0;
+
     // spells with at least one negative effect are considered negative
     // some self-applied spells have negative effects but in self casting case negative check ignored.
     for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
@@ -1650,6 +1672,10 @@ bool SpellMgr::IsNoStackSpellDueToSpell(uint32 spellId_1, uint32 spellId_2, bool
 
 SpellSpellGroupMapBounds SpellMgr::GetSpellSpellGroupMapBounds(uint32 spell_id) const
 {
+    if (SpellInfoEntry const* info = GetSpellInfo(spell_id))
+        if (!(info->flags & SPELL_INFO_SPELL_GROUP))
+            return SpellSpellGroupMapBounds(mSpellSpellGroup.end(), mSpellSpellGroup.end());
+
     spell_id = GetFirstSpellInChain(spell_id);
     return mSpellSpellGroup.equal_range(spell_id);
 }
@@ -2817,6 +2843,50 @@ void SpellMgr::LoadSpellLinked()
     sLog.outString(">> Loaded %u linked spells", count);
 }
 
+void SpellMgr::LoadSpellInfo()
+{
+    // lookups below must calculate instead of reading a half built table
+    mSpellInfo.clear();
+
+    SpellInfoStore spellInfo(GetSpellStore()->GetNumRows());
+    uint32 count = 0;
+
+    for (uint32 i = 0; i < spellInfo.size(); ++i)
+    {
+        SpellInfoEntry& entry = spellInfo[i];
+        entry.flags = 0;
+        entry.specific = SPELL_SPECIFIC_NORMAL;
+
+        if (!sSpellStore.LookupEntry(i))
+            continue;
+
+        entry.specific = CalculateSpellSpecific(i);
+
+        uint16 positive = SPELL_INFO_POSITIVE;
+        for (uint8 j = 0; j < MAX_SPELL_EFFECTS; ++j)
+        {
+            if (CalculatePositiveEffect(i, j))
+                entry.flags |= SPELL_INFO_POSITIVE_EFFECT0 << j;
+            else
+                positive = 0;
+        }
+        entry.flags |= positive;
+
+        SpellSpellGroupMapBounds groups = GetSpellSpellGroupMapBounds(i);
+        if (groups.first != groups.second)
+            entry.flags |= SPELL_INFO_SPELL_GROUP;
+
+        if (mSpellDummyConditionMap.find(i) != mSpellDummyConditionMap.end())
+            entry.flags |= SPELL_INFO_DUMMY_CONDITION;
+
+        ++count;
+    }
+
+    mSpellInfo.swap(spellInfo);
+
+    sLog.outString(">> Calculated spell info for %u spells", count);
+}
+
 // Some checks for spells, to prevent adding depricated/broken spells for trainers, spell book, etc
 bool SpellMgr::IsSpellValid(SpellEntry const* spellInfo, Player* pl, bool msg)
 {
@@ -800,6 +800,27 @@ struct SpellDummyConditionEntry
 
 typedef std::multimap<uint32, SpellDummyConditionEntry> SpellDummyConditionMap;
 
+// Facts derived from spell data that are checked over and over at runtime.
+// Calculated once for every spell after all spell tables were loaded
+// and spell data fixes were applied, see SpellMgr::LoadSpellInfo
+enum SpellInfoFlags
+{
+    SPELL_INFO_POSITIVE_EFFECT0    = 0x0001,
+    SPELL_INFO_POSITIVE_EFFECT1    = 0x0002,
+    SPELL_INFO_POSITIVE_EFFECT2    = 0x0004,
+    SPELL_INFO_POSITIVE            = 0x0008, //!< all effects are positive
+    SPELL_INFO_SPELL_GROUP         = 0x0010, //!< first rank is member of a spell group
+    SPELL_INFO_DUMMY_CONDITION     = 0x0020  //!< has spell_dummy_condition entries
+};
+
+struct SpellInfoEntry
+{
+    uint16 flags;
+    uint8 specific;                                         //!< SpellSpecific
+};
+
+typedef std::vector<SpellInfoEntry> SpellInfoStore;
+
 class SpellMgr
 {
         // Constructors
@@ -1050,6 +1071,11 @@ class SpellMgr
                 return 0;*/
         }
 
+        SpellInfoEntry const* GetSpellInfo(uint32 spell_id) const
+        {
+            return spell_id < mSpellInfo.size() ? &mSpellInfo[spell_id] : NULL;
+        }
+
         const std::vector<int32>* GetSpellLinked(int32 spell_id) const
         {
             SpellLinkedMap::const_iterator itr = mSpellLinkedMap.find(spell_id);
@@ -1061,6 +1087,10 @@ class SpellMgr
 
         const SpellDummyConditionEntry* GetSpellDummyCondition(uint32 spellId, uint32 effIndex) const
         {
+            if (SpellInfoEntry const* info = GetSpellInfo(spellId))
+                if (!(info->flags & SPELL_INFO_DUMMY_CONDITION))
+                    return NULL;
+
             typedef SpellDummyConditionMap::const_iterator Iterator;
             std::pair<Iterator, Iterator> range = mSpellDummyConditionMap.equal_range(spellId);
 
@@ -1093,6 +1123,7 @@ class SpellMgr
         void LoadSpellEnchantProcData();
         void LoadSpellDummyCondition();
         void LoadSpellGroupStackRules();
+        void LoadSpellInfo();
 
     private:
         SpellChainMap      mSpellChains;
@@ -1113,6 +1144,7 @@ class SpellMgr
         SpellGroupStackMap   mSpellGroupStack;
         SpellEnchantProcEventMap     mSpellEnchantProcEventMap;
         SpellDummyConditionMap       mSpellDummyConditionMap;
+        SpellInfoStore      mSpellInfo;
 };
 
 #define sSpellMgr SpellMgr::Instance()
@@ -0,0 +1,267 @@
+/*
+ * This file is part of the OregonCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TickProfiler.h"
+#include "Log.h"
+#include "Config/Config.h"
+
+#include <ace/TSS_T.h>
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+INSTANTIATE_SINGLETON_1(TickProfiler);
+
+volatile bool TickProfiler::s_recording = false;
+
+// per thread pointer to the thread's buffer
+struct TickProfilerThreadSlot
+{
+    TickProfilerThreadSlot() : buffer(NULL) {}
+    TickProfilerBuffer* buffer;
+};
+
+typedef ACE_TSS<TickProfilerThreadSlot> TickProfilerThreadSlotTSS;
+static TickProfilerThreadSlotTSS tickProfilerThreadSlot;
+
+TickProfiler::TickProfiler() : m_request(REQUEST_NONE), m_requestedTicks(0), m_ticksLeft(0), m_startTicks(0)
+{
+}
+
+TickProfiler::~TickProfiler()
+{
+    for (std::vector<TickProfilerBuffer*>::iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+        delete *itr;
+}
+
+void TickProfiler::RequestStart(uint32 ticks)
+{
+    m_requestedTicks = ticks;
+    m_request = REQUEST_START;
+}
+
+void TickProfiler::RequestStop()
+{
+    m_request = REQUEST_STOP;
+}
+
+void TickProfiler::Update()
+{
+    if (s_recording && m_ticksLeft && !--m_ticksLeft)
+        m_request = REQUEST_STOP;
+
+    switch (m_request)
+    {
+        case REQUEST_START:
+            if (!s_recording)
+                Start();
+            break;
+        case REQUEST_STOP:
+            if (s_recording)
+                Stop();
+            break;
+        default:
+            return;
+    }
+
+    m_request = REQUEST_NONE;
+}
+
+TickProfilerBuffer* TickProfiler::GetThreadBuffer()
+{
+    TickProfilerThreadSlot* slot = tickProfilerThreadSlot;  // created on first use in each thread
+    if (!slot)
+        return NULL;
+
+    if (!slot->buffer)
+    {
+        TickProfiler& profiler = sTickProfiler;
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, profiler.m_buffersLock, NULL);
+
+        slot->buffer = new TickProfilerBuffer(profiler.m_buffers.size());
+        slot->buffer->events.reserve(65536);
+        profiler.m_buffers.push_back(slot->buffer);
+    }
+
+    return slot->buffer;
+}
+
+TickProfilerBuffer* TickProfiler::BeginZone(const char* name, int32& index)
+{
+    TickProfilerBuffer* buffer = GetThreadBuffer();
+    if (!buffer || buffer->events.size() >= TICK_PROFILER_MAX_EVENTS)
+        return NULL;
+
+    index = int32(buffer->events.size());
+
+    TickProfilerEvent event;
+    event.name = name;
+    event.parent = buffer->current;
+    event.end = 0;
+    event.start = ReadTicks();
+    buffer->events.push_back(event);
+
+    buffer->current = index;
+    return buffer;
+}
+
+void TickProfiler::Start()
+{
+    // the world thread gets the first buffer, so it is thread 0 in the output
+    GetThreadBuffer();
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_buffersLock);
+        for (std::vector<TickProfilerBuffer*>::iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+        {
+            (*itr)->events.clear();
+            (*itr)->current = -1;
+        }
+    }
+
+    m_ticksLeft = m_requestedTicks;
+    m_startTime = ACE_OS::gettimeofday();
+    m_startTicks = ReadTicks();
+    s_recording = true;
+
+    if (m_ticksLeft)
+        sLog.outString("TickProfiler: recording the next %u world ticks", m_ticksLeft);
+    else
+        sLog.outString("TickProfiler: recording until stopped");
+}
+
+void TickProfiler::Stop()
+{
+    s_recording = false;
+
+    uint64 ticks = ReadTicks() - m_startTicks;
+    ACE_Time_Value elapsed = ACE_OS::gettimeofday() - m_startTime;
+    uint64 elapsedUs = uint64(elapsed.sec()) * 1000000 + elapsed.usec();
+    double ticksPerUs = elapsedUs ? double(ticks) / elapsedUs : 1.0;
+
+    std::string logsDir = sConfig.GetStringDefault("LogsDir", "");
+    if (!logsDir.empty() && logsDir[logsDir.length() - 1] != '/' && logsDir[logsDir.length() - 1] != '\\')
+        logsDir.append("/");
+
+    time_t now = time(NULL);
+    char fileName[64];
+    strftime(fileName, sizeof(fileName), "tickprofile_%Y-%m-%d_%H-%M-%S", localtime(&now));
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_buffersLock);
+
+    WriteChromeTrace(logsDir + fileName + ".json", ticksPerUs);
+    WriteCollapsedStacks(logsDir + fileName + ".folded", ticksPerUs);
+
+    // give the memory back, a run can easily reach a few hundred MB
+    for (std::vector<TickProfilerBuffer*>::iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+        std::vector<TickProfilerEvent>().swap((*itr)->events);
+
+    sLog.outString("TickProfiler: %u ms recorded to %s%s.json and .folded", uint32(elapsedUs / 1000), logsDir.c_str(), fileName);
+}
+
+std::string TickProfiler::GetThreadName(const TickProfilerBuffer* buffer) const
+{
+    if (!buffer->threadId)
+        return "World";
+
+    char name[32];
+    snprintf(name, sizeof(name), "Thread %u", buffer->threadId);
+    return name;
+}
+
+// Chrome trace event format, opens in chrome://tracing, Perfetto or speedscope
+void TickProfiler::WriteChromeTrace(const std::string& fileName, double ticksPerUs)
+{
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (!file)
+    {
+        sLog.outError("TickProfiler: Can't create %s", fileName.c_str());
+        return;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (std::vector<TickProfilerBuffer*>::const_iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+    {
+        const TickProfilerBuffer* buffer = *itr;
+        if (buffer->events.empty())
+            continue;
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", buffer->threadId, GetThreadName(buffer).c_str());
+        first = false;
+
+        for (std::vector<TickProfilerEvent>::const_iterator event = buffer->events.begin(); event != buffer->events.end(); ++event)
+        {
+            if (event->end < event->start)
+                continue;
+
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", event->name, buffer->threadId,
+                    (event->start - m_startTicks) / ticksPerUs, (event->end - event->start) / ticksPerUs);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+}
+
+// one "thread;zone;zone self_time_us" line per stack, the input format of flamegraph.pl
+void TickProfiler::WriteCollapsedStacks(const std::string& fileName, double ticksPerUs)
+{
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (!file)
+    {
+        sLog.outError("TickProfiler: Can't create %s", fileName.c_str());
+        return;
+    }
+
+    std::map<std::string, uint64> stacks;
+    for (std::vector<TickProfilerBuffer*>::const_iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr)
+    {
+        const std::vector<TickProfilerEvent>& events = (*itr)->events;
+        std::string threadName = GetThreadName(*itr);
+
+        // time spent in child zones, subtracted to get the self time of each zone
+        std::vector<uint64> childTicks(events.size(), 0);
+        for (uint32 i = 0; i < events.size(); ++i)
+            if (events[i].parent >= 0 && events[i].end >= events[i].start)
+                childTicks[events[i].parent] += events[i].end - events[i].start;
+
+        for (uint32 i = 0; i < events.size(); ++i)
+        {
+            if (events[i].end < events[i].start)
+                continue;
+
+            uint64 total = events[i].end - events[i].start;
+            uint64 self = total > childTicks[i] ? total - childTicks[i] : 0;
+
+            std::string stack = events[i].name;
+            for (int32 parent = events[i].parent; parent >= 0; parent = events[parent].parent)
+                stack = std::string(events[parent].name) + ";" + stack;
+
+            stacks[threadName + ";" + stack] += self;
+        }
+    }
+
+    for (std::map<std::string, uint64>::const_iterator itr = stacks.begin(); itr != stacks.end(); ++itr)
+    {
+        uint64 us = uint64(itr->second / ticksPerUs);
+        if (us)
+            fprintf(file, "%s " UI64FMTD "\n", itr->first.c_str(), us);
+    }
+
+    fclose(file);
+}
@@ -0,0 +1,143 @@
+/*
+ * This file is part of the OregonCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OREGON_TICKPROFILER_H
+#define OREGON_TICKPROFILER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/OS_NS_time.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+// max zones recorded per thread during one profiling run
+#define TICK_PROFILER_MAX_EVENTS 2000000
+
+// one finished zone, parent is the index of the enclosing zone in the same buffer or -1
+struct TickProfilerEvent
+{
+    const char* name;
+    uint64 start;
+    uint64 end;
+    int32 parent;
+};
+
+// zones of one thread, only written by that thread
+struct TickProfilerBuffer
+{
+    explicit TickProfilerBuffer(uint32 id) : threadId(id), current(-1) {}
+
+    uint32 threadId;
+    int32 current;
+    std::vector<TickProfilerEvent> events;
+};
+
+class TickProfiler
+{
+    public:
+        TickProfiler();
+        ~TickProfiler();
+
+        // Start/stop requests are only applied by Update(), between two world ticks,
+        // when no zone is open on any thread. ticks = 0 records until stopped.
+        void RequestStart(uint32 ticks);
+        void RequestStop();
+        bool IsRequestPending() const { return m_request != REQUEST_NONE; }
+
+        // called first thing in World::Update
+        void Update();
+
+        static bool IsRecording() { return s_recording; }
+
+        static uint64 ReadTicks()
+        {
+            #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            return __rdtsc();
+            #elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+            return __builtin_ia32_rdtsc();
+            #else
+            return ACE_OS::gethrtime();
+            #endif
+        }
+
+        // opens a zone in the calling thread's buffer, NULL if nothing is recorded
+        static TickProfilerBuffer* BeginZone(const char* name, int32& index);
+
+    private:
+        enum Request
+        {
+            REQUEST_NONE,
+            REQUEST_START,
+            REQUEST_STOP
+        };
+
+        void Start();
+        void Stop();
+        void WriteChromeTrace(const std::string& fileName, double ticksPerUs);
+        void WriteCollapsedStacks(const std::string& fileName, double ticksPerUs);
+        std::string GetThreadName(const TickProfilerBuffer* buffer) const;
+
+        static TickProfilerBuffer* GetThreadBuffer();
+
+        static volatile bool s_recording;
+
+        volatile Request m_request;
+        uint32 m_requestedTicks;
+        uint32 m_ticksLeft;
+
+        uint64 m_startTicks;
+        ACE_Time_Value m_startTime;
+
+        // every buffer ever handed out, owned here so they outlive their threads
+        std::vector<TickProfilerBuffer*> m_buffers;
+        ACE_Thread_Mutex m_buffersLock;
+};
+
+#define sTickProfiler Oregon::Singleton<TickProfiler>::Instance()
+
+// records the time spent in the enclosing scope while the profiler runs
+class TickProfilerZone
+{
+    public:
+        explicit TickProfilerZone(const char* name) : m_buffer(NULL), m_index(-1)
+        {
+            if (TickProfiler::IsRecording())
+                m_buffer = TickProfiler::BeginZone(name, m_index);
+        }
+
+        ~TickProfilerZone()
+        {
+            if (!m_buffer)
+                return;
+
+            TickProfilerEvent& event = m_buffer->events[m_index];
+            event.end = TickProfiler::ReadTicks();
+            m_buffer->current = event.parent;
+        }
+
+    private:
+        TickProfilerBuffer* m_buffer;
+        int32 m_index;
+};
+
+#define PROFILE_ZONE(name) TickProfilerZone _profilerZone(name)
+
+#endif
@@ -3227,11 +3227,24 @@ uint32 Unit::GetWeaponSkillValue (WeaponAttackType attType, Unit const* target)
 
 void Unit::_DeleteAuras()
 {
+    // singlecast auras leave this list when they end on their target, which doesn't go
+    // through our m_removedAuras, so the list is compacted on every update of the caster
+    m_scAuras.Compact();
+
+    if (m_removedAuras.empty())
+        return;
+
     while (!m_removedAuras.empty())
     {
         delete m_removedAuras.front();
         m_removedAuras.pop_front();
     }
+
+    // nothing iterates the aura indexes here, drop slots of removed auras
+    for (uint32 i = 0; i < TOTAL_AURAS; ++i)
+        m_modAuras[i].Compact();
+    m_interruptableAuras.Compact();
+    m_ccAuras.Compact();
 }
 
 void Unit::_UpdateSpells(uint32 time)
@@ -12289,6 +12302,7 @@ void Unit::NearTeleportTo(float x, float y, float z, float orientation, bool cas
     else
     {
         Position pos = {x, y, z, orientation};
+        GetMap()->CancelMovementHeartbeat(this);
         SendTeleportPacket(pos);
         SetPosition(x, y, z, orientation, true);
         UpdateObjectVisibility();
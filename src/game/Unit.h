@@ -866,6 +866,104 @@ enum
 #define ATTACK_DISPLAY_DELAY 200
 #define MAX_PLAYER_STEALTH_DETECT_RANGE 30.0f               // max distance for detection targets by player
 
+// Contiguous list of aura pointers, used for the per aura type indexes of Unit.
+// Auras are removed while callers iterate these lists, so removal only clears
+// the slot and iterators skip cleared slots; the slots are compacted by
+// Unit::_DeleteAuras once no iteration can be in progress anymore.
+// Iterators are index based and stay valid when the storage grows.
+class UnitAuraList
+{
+    public:
+        class iterator
+        {
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef Aura* value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Aura* const* pointer;
+                typedef Aura* const& reference;
+
+                iterator() : m_list(NULL), m_index(0) {}
+                iterator(UnitAuraList const* list, size_t index) : m_list(list), m_index(index) { SkipRemoved(); }
+
+                Aura* const& operator*() const { return m_list->m_auras[m_index]; }
+                iterator& operator++() { ++m_index; SkipRemoved(); return *this; }
+                iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+                iterator& operator--()
+                {
+                    do
+                        --m_index;
+                    while (m_index && !m_list->m_auras[m_index]);
+                    return *this;
+                }
+                iterator operator--(int) { iterator tmp = *this; --*this; return tmp; }
+
+                bool operator==(iterator const& right) const
+                {
+                    bool atEnd = !m_list || m_index >= m_list->m_auras.size();
+                    bool rightAtEnd = !right.m_list || right.m_index >= right.m_list->m_auras.size();
+                    return atEnd == rightAtEnd && (atEnd || m_index == right.m_index);
+                }
+                bool operator!=(iterator const& right) const { return !(*this == right); }
+
+            private:
+                void SkipRemoved()
+                {
+                    while (m_list && m_index < m_list->m_auras.size() && !m_list->m_auras[m_index])
+                        ++m_index;
+                }
+
+                UnitAuraList const* m_list;
+                size_t m_index;
+        };
+        typedef iterator const_iterator;
+
+        UnitAuraList() : m_size(0) {}
+
+        iterator begin() const { return iterator(this, 0); }
+        iterator end() const { return iterator(this, m_auras.size()); }
+        bool empty() const { return !m_size; }
+        size_t size() const { return m_size; }
+        Aura* front() const { return *begin(); }
+        Aura* back() const { return *--end(); }
+
+        void push_back(Aura* aura)
+        {
+            m_auras.push_back(aura);
+            ++m_size;
+        }
+
+        // removes all occurrences, as std::list::remove does
+        void remove(Aura* aura)
+        {
+            for (std::vector<Aura*>::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+            {
+                if (*itr == aura)
+                {
+                    *itr = NULL;
+                    --m_size;
+                }
+            }
+        }
+
+        void clear()
+        {
+            m_auras.clear();
+            m_size = 0;
+        }
+
+        // drop cleared slots, must not be called while the list is iterated
+        void Compact()
+        {
+            if (m_size != m_auras.size())
+                m_auras.erase(std::remove(m_auras.begin(), m_auras.end(), (Aura*)NULL), m_auras.end());
+        }
+
+    private:
+        std::vector<Aura*> m_auras;
+        size_t m_size;
+};
+
 struct SpellProcEventEntry;                                 // used only privately
 
 class Unit : public WorldObject
@@ -877,7 +975,7 @@ class Unit : public WorldObject
         typedef std::set<Unit*> ControlList;
         typedef std::pair<uint32, uint8> spellEffectPair;
         typedef std::multimap< spellEffectPair, Aura*> AuraMap;
-        typedef std::list<Aura*> AuraList;
+        typedef UnitAuraList AuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef std::set<AuraType> AuraTypeSet;
         typedef std::set<uint32> ComboPointHolderSet;
@@ -2138,7 +2236,7 @@ class Unit : public WorldObject
         std::list<GameObject*> m_gameObj;
         bool m_isSorted;
         uint32 m_transform;
-        AuraList m_removedAuras;
+        std::list<Aura*> m_removedAuras;
 
         AuraList m_modAuras[TOTAL_AURAS];
         AuraList m_scAuras;                        // casted singlecast auras
@@ -294,6 +294,8 @@ bool FlightPathMovementGenerator::Update(Player& player, const uint32& diff)
             departureEvent = !departureEvent;
         }
         while (true);
+
+        PreloadGridsAhead(player);
     }
 
     return i_currentNode < (i_path->size()-1);
@@ -342,6 +344,21 @@ void FlightPathMovementGenerator::InitEndGridInfo()
     m_endGridY = (*i_path)[nodeCount - 1].y;
 }
 
+void FlightPathMovementGenerator::PreloadGridsAhead(Player& player)
+{
+    // queue the grids of the next path nodes up to one grid away,
+    // the map loads them before the player gets there
+    uint32 end = GetPathAtMapEnd();
+    float dist = 0.0f;
+    for (uint32 i = i_currentNode + 1; i < end && dist < SIZE_OF_GRIDS; ++i)
+    {
+        TaxiPathNodeEntry const& prev = (*i_path)[i - 1];
+        TaxiPathNodeEntry const& node = (*i_path)[i];
+        dist += sqrt((node.x - prev.x) * (node.x - prev.x) + (node.y - prev.y) * (node.y - prev.y));
+        player.GetMap()->PreloadGrid(node.x, node.y);
+    }
+}
+
 void FlightPathMovementGenerator::PreloadEndGrid()
 {
     // used to preload the final grid where the flightmaster is
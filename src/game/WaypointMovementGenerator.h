@@ -129,6 +129,7 @@ private:
 	float m_endGridX;
 	float m_endGridY;
 	void PreloadEndGrid();
+	void PreloadGridsAhead(Player&);
 	void InitEndGridInfo();
 };
 #endif
@@ -66,6 +66,7 @@
 #include "ConditionMgr.h"
 #include "VMapManager2.h"
 #include "M2Stores.h"
+#include "TickProfiler.h"
 
 #include <ace/Dirent.h>
 
@@ -549,6 +550,7 @@ void World::LoadConfigSettings(bool reload)
     }
     m_configs[CONFIG_ADDON_CHANNEL] = sConfig.GetBoolDefault("AddonChannel", true);
     m_configs[CONFIG_GRID_UNLOAD] = sConfig.GetBoolDefault("GridUnload", true);
+    m_configs[CONFIG_GRID_PRELOAD] = sConfig.GetIntDefault("GridPreload", 1);
     m_configs[CONFIG_INTERVAL_SAVE] = sConfig.GetIntDefault("PlayerSaveInterval", 900000);
     m_configs[CONFIG_INTERVAL_DISCONNECT_TOLERANCE] = sConfig.GetIntDefault("DisconnectToleranceInterval", 0);
 
@@ -782,6 +784,10 @@ void World::LoadConfigSettings(bool reload)
 
     m_configs[CONFIG_GROUP_VISIBILITY] = sConfig.GetIntDefault("Visibility.GroupMode", 1);
 
+    m_configs[CONFIG_MOVEMENT_RELAY_INTERVAL] = sConfig.GetIntDefault("Movement.RelayInterval", 100);
+    m_configs[CONFIG_MOVEMENT_RELAY_LOD_DISTANCE] = sConfig.GetIntDefault("Movement.RelayLodDistance", 40);
+    m_configs[CONFIG_MOVEMENT_RELAY_LOD_INTERVAL] = sConfig.GetIntDefault("Movement.RelayLodInterval", 1500);
+
     m_configs[CONFIG_MAIL_DELIVERY_DELAY] = sConfig.GetIntDefault("MailDeliveryDelay", HOUR);
 
     m_configs[CONFIG_EXTERNAL_MAIL] = sConfig.GetIntDefault("ExternalMail", 0);
@@ -1414,6 +1420,9 @@ void World::SetInitialWorldSettings()
     sConsole.SetLoadingLabel("Loading custom spell cooldowns...");
     sSpellMgr.LoadSpellCustomCooldowns();
 
+    sConsole.SetLoadingLabel("Calculating Spell Info...");
+    sSpellMgr.LoadSpellInfo();                               // must be after all spell data fixes and spell groups
+
     sConsole.SetLoadingLabel("Loading Player Create Data...");
     sObjectMgr.LoadPlayerInfo();
 
@@ -1583,6 +1592,9 @@ void World::SetInitialWorldSettings()
 
     m_timers[WUPDATE_DELETECHARS].SetInterval(DAY * IN_MILLISECONDS); // check for chars to delete every day
 
+    m_timers[WUPDATE_RESPAWNTIMES].SetInterval(5 * IN_MILLISECONDS);
+    // write collected creature/gameobject respawn times every 5 seconds
+
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
     //one second is 1000 -(tested on win system)
@@ -1760,6 +1772,9 @@ void World::LoadOpcodeProtection()
     QueryResult_AutoPtr result = WorldDatabase.Query("SELECT `opcode`, `threshold`, `interval`, `penalty` FROM opcode_protection");
     uint64 count = 0;
 
+    _protectedOpcodeSlots.assign(NUM_MSG_TYPES, -1);
+    _protectedOpcodesProperties.clear();
+
     if (result)
     {
         do
@@ -1771,29 +1786,37 @@ void World::LoadOpcodeProtection()
             if (opcode >= NUM_MSG_TYPES)
                 continue;
 
+            prop.opcode = opcode;
             prop.threshold = field[1].GetUInt32();
             prop.interval = field[2].GetUInt32();
             prop.penalty = (OpcodePenalty) field[3].GetUInt8();
 
             opcodeTable[opcode].status |= STATUS_PROTECTED;
-            _protectedOpcodesProperties[opcode] = prop;
+            if (_protectedOpcodeSlots[opcode] >= 0)
+                _protectedOpcodesProperties[_protectedOpcodeSlots[opcode]] = prop;
+            else
+            {
+                _protectedOpcodeSlots[opcode] = int32(_protectedOpcodesProperties.size());
+                _protectedOpcodesProperties.push_back(prop);
+            }
 
             count++;
         }
         while (result->NextRow());
     }
 
-    sLog.outString(">> Loaded %lu opcode protections.", count);
-}
+    _protectedOpcodeDrops.assign(_protectedOpcodesProperties.size(), ACE_Atomic_Op<ACE_Thread_Mutex, long>(0));
+    _protectedOpcodeKicks.assign(_protectedOpcodesProperties.size(), ACE_Atomic_Op<ACE_Thread_Mutex, long>(0));
 
-ProtectedOpcodeProperties const& World::GetProtectedOpcodeProperties(uint32 opcode)
-{
-    return _protectedOpcodesProperties[opcode];
+    sLog.outString(">> Loaded %lu opcode protections.", count);
 }
 
 // Update the World !
 void World::Update(uint32 diff)
 {
+    sTickProfiler.Update();
+    PROFILE_ZONE("World::Update");
+
     m_updateTime = uint32(diff);
     if (m_configs[CONFIG_INTERVAL_LOG_UPDATE])
     {
@@ -1936,6 +1959,12 @@ void World::Update(uint32 diff)
     UpdateResultQueue();
     RecordTimeDiff("UpdateResultQueue");
 
+    if (m_timers[WUPDATE_RESPAWNTIMES].Passed())
+    {
+        m_timers[WUPDATE_RESPAWNTIMES].Reset();
+        sObjectMgr.SaveRespawnTimes();
+    }
+
     // Erase corpses once every 20 minutes
     if (m_timers[WUPDATE_CORPSES].Passed())
     {
@@ -2401,6 +2430,8 @@ void World::SendServerMessage(ServerMessageType type, const char* text, Player*
 
 void World::UpdateSessions(time_t diff)
 {
+    PROFILE_ZONE("World::UpdateSessions");
+
     // Add new sessions
     WorldSession* sess;
     while (addSessQueue.next(sess))
@@ -2490,6 +2521,8 @@ void World::InitResultQueue()
 
 void World::UpdateResultQueue()
 {
+    PROFILE_ZONE("World::UpdateResultQueue");
+
     m_resultQueue->Update();
 }
 
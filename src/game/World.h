@@ -75,7 +75,8 @@ enum WorldTimers
     WUPDATE_CLEANDB     = 7,
     WUPDATE_DELETECHARS = 8,
     WUPDATE_AUTOBROADCAST = 9,
-    WUPDATE_COUNT       = 10
+    WUPDATE_RESPAWNTIMES = 10,
+    WUPDATE_COUNT       = 11
 };
 
 // Configuration elements
@@ -83,6 +84,7 @@ enum WorldConfigs
 {
     CONFIG_COMPRESSION = 0,
     CONFIG_GRID_UNLOAD,
+    CONFIG_GRID_PRELOAD,
     CONFIG_INTERVAL_SAVE,
     CONFIG_INTERVAL_GRIDCLEAN,
     CONFIG_INTERVAL_MAPUPDATE,
@@ -140,6 +142,9 @@ enum WorldConfigs
     CONFIG_ALLOW_GM_GROUP,
     CONFIG_ALLOW_GM_FRIEND,
     CONFIG_GROUP_VISIBILITY,
+    CONFIG_MOVEMENT_RELAY_INTERVAL,
+    CONFIG_MOVEMENT_RELAY_LOD_DISTANCE,
+    CONFIG_MOVEMENT_RELAY_LOD_INTERVAL,
     CONFIG_MAIL_DELIVERY_DELAY,
     CONFIG_EXTERNAL_MAIL,
     CONFIG_EXTERNAL_MAIL_INTERVAL,
@@ -446,6 +451,7 @@ enum OpcodePenalty
 /// Protected Opcode @see Opcodes.h
 struct ProtectedOpcodeProperties
 {
+    uint32 opcode;
     uint32 threshold;      //!< Sets the maximum count one protected packet per Interval can be processed per session.
     uint32 interval;       //!< Interval for threshold, in milliseconds.'
     OpcodePenalty penalty; //!< What should happen if the threshold per interval is passed.
@@ -774,7 +780,18 @@ class World
         void LoadOpcodeProtection();
         void LoadSQLUpdates();
 
-        ProtectedOpcodeProperties const& GetProtectedOpcodeProperties(uint32 opcode);
+        // protected opcodes are numbered from 0 in load order, -1 if the opcode is not protected
+        int32 GetProtectedOpcodeSlot(uint32 opcode) const
+        {
+            return opcode < _protectedOpcodeSlots.size() ? _protectedOpcodeSlots[opcode] : -1;
+        }
+        uint32 GetProtectedOpcodeCount() const { return _protectedOpcodesProperties.size(); }
+        ProtectedOpcodeProperties const& GetProtectedOpcodeProperties(uint32 slot) const { return _protectedOpcodesProperties[slot]; }
+
+        // packets dropped or sessions kicked by the network threads, see WorldSocket::CheckOpcodeRate
+        void AddThrottledPacket(uint32 slot, bool kicked) { ++(kicked ? _protectedOpcodeKicks : _protectedOpcodeDrops)[slot]; }
+        long GetThrottledPackets(uint32 slot) const { return _protectedOpcodeDrops[slot].value(); }
+        long GetThrottleKicks(uint32 slot) const { return _protectedOpcodeKicks[slot].value(); }
     protected:
         void _UpdateGameTime();
         // callback for UpdateRealmCharacters
@@ -852,7 +869,11 @@ class World
 
         std::list<std::string> m_Autobroadcasts;
         std::string m_SQLUpdatesPath;
-        UNORDERED_MAP<uint32, ProtectedOpcodeProperties> _protectedOpcodesProperties;
+        // filled at startup only, read by the network threads without locking
+        std::vector<int32> _protectedOpcodeSlots;
+        std::vector<ProtectedOpcodeProperties> _protectedOpcodesProperties;
+        std::vector<ACE_Atomic_Op<ACE_Thread_Mutex, long> > _protectedOpcodeDrops;
+        std::vector<ACE_Atomic_Op<ACE_Thread_Mutex, long> > _protectedOpcodeKicks;
 };
 
 extern uint32 realmID;
@@ -748,15 +748,6 @@ class WorldSession
         uint32 m_latency;
         uint32 m_clientTimeDelay;
 
-        struct ProtectedOpcodeStatus
-        {
-            uint64 lastUsed;
-            uint32 timesUsed;
-        };
-        
-        typedef UNORDERED_MAP<uint32, ProtectedOpcodeStatus> ProtectedOpcodeMap;
-        ProtectedOpcodeMap _protectedOpcodes;
-
         ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
 };
 #endif
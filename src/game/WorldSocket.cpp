@@ -22,6 +22,8 @@
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
+#include <ace/os_include/sys/os_uio.h>
+#include <ace/OS_NS_sys_socket.h>
 #include <ace/Reactor.h>
 #include <ace/Auto_Ptr.h>
 
@@ -66,6 +68,21 @@ struct ClientPktHeader
 #pragma pack(pop)
 #endif
 
+// Outgoing packet, the header is encrypted by the network thread when the
+// node moves from the send queue to the output queue.
+struct WorldSocketPacketNode : public WorldSocketSendNode
+{
+    explicit WorldSocketPacketNode (const WorldPacket& pct) : packet (pct) {}
+
+    size_t TotalSize() const { return sizeof (ServerPktHeader) + packet.size(); }
+
+    ServerPktHeader header;
+    WorldPacket packet;
+};
+
+// Max packets gathered in one send call, two iovecs each.
+#define WORLDSOCKET_MAX_IOV_PACKETS 64
+
 WorldSocket::WorldSocket (void) :
     WorldHandler(),
     m_LastPingTime(ACE_Time_Value::zero),
@@ -74,8 +91,17 @@ WorldSocket::WorldSocket (void) :
     m_RecvWPct(0),
     m_RecvPct(),
     m_Header(sizeof (ClientPktHeader)),
-    m_OutBuffer(0),
+    m_SkipPacket(false),
+    m_SkipPayload(0),
+    m_SendQueueHead(&m_SendQueueStub),
+    m_SendQueueTail(&m_SendQueueStub),
+    m_OutQueueHead(NULL),
+    m_OutQueueTail(NULL),
+    m_OutQueueSent(0),
     m_OutBufferSize(65536),
+    m_InBuffer(NULL),
+    m_InBufferSize(16384),
+    m_EpollThread(NULL),
     m_OutActive(false),
     m_Seed(static_cast<uint32> (rand32()))
 {
@@ -85,17 +111,19 @@ WorldSocket::WorldSocket (void) :
 WorldSocket::~WorldSocket (void)
 {
     delete m_RecvWPct;
-
-    if (m_OutBuffer)
-        m_OutBuffer->release();
+    delete[] m_InBuffer;
 
     closing_ = true;
 
     peer().close();
 
-    WorldPacket* pct;
-    while (m_PacketQueue.dequeue_head (pct) == 0)
-        delete pct;
+    FlushSendQueue();
+
+    while (WorldSocketSendNode* node = m_OutQueueHead)
+    {
+        m_OutQueueHead = node->next.load (std::memory_order_relaxed);
+        delete static_cast<WorldSocketPacketNode*> (node);
+    }
 }
 
 bool WorldSocket::IsClosed (void) const
@@ -106,7 +134,7 @@ bool WorldSocket::IsClosed (void) const
 void WorldSocket::CloseSocket (void)
 {
     {
-        ACE_GUARD (LockType, Guard, m_OutBufferLock);
+        ACE_GUARD (LockType, Guard, m_CloseLock);
 
         if (closing_)
             return;
@@ -129,8 +157,6 @@ const std::string& WorldSocket::GetRemoteAddress (void) const
 
 int WorldSocket::SendPacket (const WorldPacket& pct)
 {
-    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
-
     if (closing_)
         return -1;
 
@@ -154,23 +180,96 @@ int WorldSocket::SendPacket (const WorldPacket& pct)
         sLog.outNetwork("");
     }
 
-    if (iSendPacket (pct) == -1)
+    WorldSocketPacketNode* node;
+
+    ACE_NEW_RETURN (node, WorldSocketPacketNode (pct), -1);
+
+    // the network thread picks it up on its next Update()
+    PushSendQueue (node);
+
+    return 0;
+}
+
+void WorldSocket::PushSendQueue (WorldSocketSendNode* node)
+{
+    node->next.store (NULL, std::memory_order_relaxed);
+
+    WorldSocketSendNode* prev = m_SendQueueHead.exchange (node, std::memory_order_acq_rel);
+
+    // between the exchange and this store the node is not reachable from the tail yet,
+    // the consumer then sees a shorter queue and gets the rest on the next pass
+    prev->next.store (node, std::memory_order_release);
+}
+
+WorldSocketSendNode* WorldSocket::PopSendQueue (void)
+{
+    WorldSocketSendNode* tail = m_SendQueueTail;
+    WorldSocketSendNode* next = tail->next.load (std::memory_order_acquire);
+
+    if (tail == &m_SendQueueStub)
     {
-        WorldPacket* npct;
+        if (!next)
+            return NULL;
 
-        ACE_NEW_RETURN (npct, WorldPacket (pct), -1);
+        m_SendQueueTail = next;
+        tail = next;
+        next = next->next.load (std::memory_order_acquire);
+    }
 
-        // NOTE maybe check of the size of the queue can be good ?
-        // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail (npct) == -1)
-        {
-            delete npct;
-            sLog.outError ("WorldSocket::SendPacket: m_PacketQueue.enqueue_tail failed");
-            return -1;
-        }
+    if (next)
+    {
+        m_SendQueueTail = next;
+        return tail;
     }
 
-    return 0;
+    // tail is the last linked node, a producer may be linking one behind it
+    if (tail != m_SendQueueHead.load (std::memory_order_acquire))
+        return NULL;
+
+    // put the stub back behind the last node so it can be unlinked
+    PushSendQueue (&m_SendQueueStub);
+
+    next = tail->next.load (std::memory_order_acquire);
+
+    if (next)
+    {
+        m_SendQueueTail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+void WorldSocket::FlushSendQueue (void)
+{
+    while (WorldSocketSendNode* node = PopSendQueue())
+    {
+        WorldSocketPacketNode* pct = static_cast<WorldSocketPacketNode*> (node);
+
+        pct->header.cmd = pct->packet.GetOpcode ();
+        EndianConvert(pct->header.cmd);
+
+        pct->header.size = (uint16) pct->packet.size () + 2;
+        EndianConvertReverse(pct->header.size);
+
+        m_Crypt.EncryptSend ((uint8*) & pct->header, sizeof (pct->header));
+
+        pct->next.store (NULL, std::memory_order_relaxed);
+
+        if (m_OutQueueTail)
+            m_OutQueueTail->next.store (pct, std::memory_order_relaxed);
+        else
+            m_OutQueueHead = pct;
+
+        m_OutQueueTail = pct;
+    }
+}
+
+bool WorldSocket::HasPendingOutput (void) const
+{
+    return m_OutQueueHead ||
+           m_SendQueueTail != &m_SendQueueStub ||
+           m_SendQueueStub.next.load (std::memory_order_acquire);
 }
 
 long WorldSocket::AddReference (void)
@@ -188,7 +287,7 @@ int WorldSocket::open (void* a)
     ACE_UNUSED_ARG (a);
 
     // Prevent double call to this func.
-    if (m_OutBuffer)
+    if (m_InBuffer)
         return -1;
 
     // This will also prevent the socket from being Updated
@@ -200,7 +299,7 @@ int WorldSocket::open (void* a)
         return -1;
 
     // Allocate the buffer.
-    ACE_NEW_RETURN (m_OutBuffer, ACE_Message_Block (m_OutBufferSize), -1);
+    ACE_NEW_RETURN (m_InBuffer, char[m_InBufferSize], -1);
 
     // Store peer address.
     ACE_INET_Addr remote_addr;
@@ -220,14 +319,14 @@ int WorldSocket::open (void* a)
     if (SendPacket (packet) == -1)
         return -1;
 
-    // Register with ACE Reactor
-    if (reactor()->register_handler(this, ACE_Event_Handler::READ_MASK | ACE_Event_Handler::WRITE_MASK) == -1)
+    // Register with ACE Reactor, the epoll thread registers the socket itself
+    if (!m_EpollThread && reactor()->register_handler(this, ACE_Event_Handler::READ_MASK | ACE_Event_Handler::WRITE_MASK) == -1)
     {
         sLog.outError ("WorldSocket::open: unable to register client handler errno = %s", ACE_OS::strerror (errno));
         return -1;
     }
 
-    // reactor takes care of the socket from now on
+    // reactor (or the network thread's socket set with epoll) takes care of the socket from now on
     remove_reference();
 
     return 0;
@@ -282,20 +381,53 @@ int WorldSocket::handle_input (ACE_HANDLE)
 
 int WorldSocket::handle_output (ACE_HANDLE)
 {
-    ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
-
     if (closing_)
         return -1;
 
-    const size_t send_len = m_OutBuffer->length ();
+    FlushSendQueue();
+
+    if (!m_OutQueueHead)
+        return cancel_wakeup_output();
+
+    // gather the output queue, the first packet may have been sent partially
+    iovec iov[WORLDSOCKET_MAX_IOV_PACKETS * 2];
+    int iovcnt = 0;
+    size_t send_len = 0;
+    size_t skip = m_OutQueueSent;
+
+    for (WorldSocketSendNode* node = m_OutQueueHead; node && iovcnt + 2 <= WORLDSOCKET_MAX_IOV_PACKETS * 2 &&
+        send_len < m_OutBufferSize; node = node->next.load (std::memory_order_relaxed))
+    {
+        WorldSocketPacketNode* pct = static_cast<WorldSocketPacketNode*> (node);
+
+        char* parts[2] = { (char*) & pct->header, pct->packet.empty() ? NULL : (char*) pct->packet.contents() };
+        size_t sizes[2] = { sizeof (pct->header), pct->packet.size() };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (skip >= sizes[i])
+            {
+                skip -= sizes[i];
+                continue;
+            }
 
-    if (send_len == 0)
-        return cancel_wakeup_output (Guard);
+            iov[iovcnt].iov_base = parts[i] + skip;
+            iov[iovcnt].iov_len = sizes[i] - skip;
+            send_len += sizes[i] - skip;
+            skip = 0;
+            ++iovcnt;
+        }
+    }
 
     #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send (m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+    msghdr msg;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    ssize_t n = ACE_OS::sendmsg (get_handle(), &msg, MSG_NOSIGNAL);
     #else
-    ssize_t n = peer().send (m_OutBuffer->rd_ptr(), send_len);
+    ssize_t n = peer().sendv (iov, iovcnt);
     #endif // MSG_NOSIGNAL
 
     if (n == 0)
@@ -303,37 +435,42 @@ int WorldSocket::handle_output (ACE_HANDLE)
     else if (n == -1)
     {
         if (errno == EWOULDBLOCK || errno == EAGAIN)
-            return schedule_wakeup_output (Guard);
+            return schedule_wakeup_output();
 
         return -1;
     }
-    else if (size_t(n) < send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr (static_cast<size_t> (n));
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
+    // release what the kernel took, keep the offset into a partially sent packet
+    size_t sent = m_OutQueueSent + size_t(n);
 
-        return schedule_wakeup_output (Guard);
-    }
-    else //now n == send_len
+    while (m_OutQueueHead)
     {
-        m_OutBuffer->reset();
+        WorldSocketPacketNode* pct = static_cast<WorldSocketPacketNode*> (m_OutQueueHead);
 
-        if (!iFlushPacketQueue ())
-            return cancel_wakeup_output (Guard);
-        else
-            return schedule_wakeup_output (Guard);
+        if (sent < pct->TotalSize())
+            break;
+
+        sent -= pct->TotalSize();
+        m_OutQueueHead = pct->next.load (std::memory_order_relaxed);
+        delete pct;
     }
 
-    ACE_NOTREACHED (return 0);
+    if (!m_OutQueueHead)
+        m_OutQueueTail = NULL;
+
+    m_OutQueueSent = sent;
+
+    if (!HasPendingOutput())
+        return cancel_wakeup_output();
+    else
+        return schedule_wakeup_output();
 }
 
 int WorldSocket::handle_close (ACE_HANDLE h, ACE_Reactor_Mask)
 {
     // Critical section
     {
-        ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
+        ACE_GUARD_RETURN (LockType, Guard, m_CloseLock, -1);
 
         closing_ = true;
 
@@ -357,7 +494,7 @@ int WorldSocket::Update (void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || m_OutBuffer->length () == 0)
+    if (m_OutActive || !HasPendingOutput())
         return 0;
 
     return handle_output (get_handle ());
@@ -387,6 +524,19 @@ int WorldSocket::handle_input_header (void)
 
     header.size -= 4;
 
+    switch (CheckOpcodeRate ((uint16) header.cmd))
+    {
+        case 0:
+            break;
+        case 1:
+            m_SkipPacket = true;
+            m_SkipPayload = header.size;
+            return 0;
+        default:
+            errno = EINVAL;
+            return -1;
+    }
+
     ACE_NEW_RETURN (m_RecvWPct, WorldPacket ((uint16) header.cmd, header.size), -1);
 
     if (header.size > 0)
@@ -425,11 +575,9 @@ int WorldSocket::handle_input_payload (void)
 
 int WorldSocket::handle_input_missing_data (void)
 {
-    char buf [1024];
-
-    ACE_Data_Block db (sizeof (buf),
+    ACE_Data_Block db (m_InBufferSize,
                        ACE_Message_Block::MB_DATA,
-                       buf,
+                       m_InBuffer,
                        0,
                        0,
                        ACE_Message_Block::DONT_DELETE,
@@ -474,6 +622,25 @@ int WorldSocket::handle_input_missing_data (void)
             }
         }
 
+        // throttled packet, its payload is only skipped
+        if (m_SkipPacket)
+        {
+            const size_t to_skip = (message_block.length() > m_SkipPayload ? m_SkipPayload : message_block.length());
+            message_block.rd_ptr (to_skip);
+            m_SkipPayload -= to_skip;
+
+            if (m_SkipPayload > 0)
+            {
+                ACE_ASSERT (message_block.length() == 0);
+                errno = EWOULDBLOCK;
+                return -1;
+            }
+
+            m_SkipPacket = false;
+            m_Header.reset();
+            continue;
+        }
+
         // Its possible on some error situations that this happens
         // for example on closing when epoll receives more chunked data and stuff
         // hope this is not hack ,as proper m_RecvWPct is asserted around
@@ -512,14 +679,16 @@ int WorldSocket::handle_input_missing_data (void)
     return size_t(n) == recv_size ? 1 : 2;
 }
 
-int WorldSocket::cancel_wakeup_output (GuardType& g)
+int WorldSocket::cancel_wakeup_output (void)
 {
     if (!m_OutActive)
         return 0;
 
     m_OutActive = false;
 
-    g.release();
+    // epoll watches EPOLLOUT edge-triggered all the time
+    if (m_EpollThread)
+        return 0;
 
     if (reactor()->cancel_wakeup
         (this, ACE_Event_Handler::WRITE_MASK) == -1)
@@ -532,14 +701,15 @@ int WorldSocket::cancel_wakeup_output (GuardType& g)
     return 0;
 }
 
-int WorldSocket::schedule_wakeup_output (GuardType& g)
+int WorldSocket::schedule_wakeup_output (void)
 {
     if (m_OutActive)
         return 0;
 
     m_OutActive = true;
 
-    g.release();
+    if (m_EpollThread)
+        return 0;
 
     if (reactor()->schedule_wakeup
         (this, ACE_Event_Handler::WRITE_MASK) == -1)
@@ -551,6 +721,63 @@ int WorldSocket::schedule_wakeup_output (GuardType& g)
     return 0;
 }
 
+int WorldSocket::CheckOpcodeRate (uint16 opcode)
+{
+    const int32 slot = sWorld.GetProtectedOpcodeSlot (opcode);
+    if (slot < 0)
+        return 0;
+
+    ProtectedOpcodeProperties const& prop = sWorld.GetProtectedOpcodeProperties (slot);
+
+    if (m_OpcodeBuckets.size() <= size_t(slot))
+        m_OpcodeBuckets.resize (sWorld.GetProtectedOpcodeCount());
+
+    // threshold packets per interval, with bursts of up to threshold packets
+    OpcodeBucket& bucket = m_OpcodeBuckets[slot];
+    const uint64 now = getMSTime64();
+
+    if (!bucket.lastRefill)
+    {
+        bucket.tokens = prop.threshold;
+        bucket.lastRefill = now;
+    }
+    else
+    {
+        const uint64 refill = prop.interval ? getMSTimeDiff64 (bucket.lastRefill, now) * prop.threshold / prop.interval : prop.threshold;
+        if (refill)
+        {
+            if (bucket.tokens + refill >= prop.threshold)
+            {
+                bucket.tokens = prop.threshold;
+                bucket.lastRefill = now;
+            }
+            else
+            {
+                bucket.tokens += uint32(refill);
+                bucket.lastRefill += refill * prop.interval / prop.threshold;
+            }
+        }
+    }
+
+    if (bucket.tokens)
+    {
+        --bucket.tokens;
+        return 0;
+    }
+
+    const bool kick = prop.penalty == OPCODE_PENALTY_KICK;
+    sWorld.AddThrottledPacket (slot, kick);
+
+    if (kick)
+    {
+        sLog.outError ("WorldSocket::CheckOpcodeRate: client %s exceeded the rate of %s, closing connection",
+                       GetRemoteAddress().c_str(), LookupOpcodeName (opcode));
+        return -1;
+    }
+
+    return 1;
+}
+
 int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
 {
     ACE_ASSERT (new_pct);
@@ -860,6 +1087,9 @@ int WorldSocket::HandleAuthSession (WorldPacket& recvPacket)
     // NOTE ATM the socket is single-threaded, have this in mind ...
     ACE_NEW_RETURN (m_Session, WorldSession (id, this, security, expansion, mutetime, locale), -1);
 
+    // packets queued until now go out unencrypted
+    FlushSendQueue();
+
     m_Crypt.SetKey(&K);
     m_Crypt.Init();
 
@@ -945,60 +1175,3 @@ int WorldSocket::HandlePing (WorldPacket& recvPacket)
     packet << ping;
     return SendPacket (packet);
 }
-
-int WorldSocket::iSendPacket (const WorldPacket& pct)
-{
-    if (m_OutBuffer->space () < pct.size () + sizeof (ServerPktHeader))
-    {
-        errno = ENOBUFS;
-        return -1;
-    }
-
-    ServerPktHeader header;
-
-    header.cmd = pct.GetOpcode ();
-    EndianConvert(header.cmd);
-
-    header.size = (uint16) pct.size () + 2;
-    EndianConvertReverse(header.size);
-
-    m_Crypt.EncryptSend ((uint8*) & header, sizeof (header));
-
-    if (m_OutBuffer->copy ((char*) & header, sizeof (header)) == -1)
-        ACE_ASSERT (false);
-
-    if (!pct.empty ())
-        if (m_OutBuffer->copy ((char*) pct.contents (), pct.size ()) == -1)
-            ACE_ASSERT (false);
-
-    return 0;
-}
-
-bool WorldSocket::iFlushPacketQueue ()
-{
-    WorldPacket* pct;
-    bool haveone = false;
-
-    while (m_PacketQueue.dequeue_head (pct) == 0)
-    {
-        if (iSendPacket (*pct) == -1)
-        {
-            if (m_PacketQueue.enqueue_head (pct) == -1)
-            {
-                delete pct;
-                sLog.outError ("WorldSocket::iFlushPacketQueue m_PacketQueue->enqueue_head");
-                return false;
-            }
-
-            break;
-        }
-        else
-        {
-            haveone = true;
-            delete pct;
-        }
-    }
-
-    return haveone;
-}
-
@@ -26,9 +26,10 @@
 #include <ace/Acceptor.h>
 #include <ace/Thread_Mutex.h>
 #include <ace/Guard_T.h>
-#include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
 
+#include <atomic>
+
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
 #endif /* ACE_LACKS_PRAGMA_ONCE */
@@ -39,10 +40,19 @@
 class ACE_Message_Block;
 class WorldPacket;
 class WorldSession;
+class ReactorRunnable;
 
 // Handler that can communicate over stream sockets.
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
 
+// Intrusive link of an outgoing packet, the packet itself lives in WorldSocket.cpp.
+struct WorldSocketSendNode
+{
+    WorldSocketSendNode() : next(NULL) {}
+
+    std::atomic<WorldSocketSendNode*> next;
+};
+
 /**
  * WorldSocket.
  *
@@ -51,26 +61,33 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  * Most methods return -1 on failure.
  * The class uses reference counting.
  *
- * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
- * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
- * written to the output buffer the socket is not immediately
- * activated for output (again for the same reason), there
- * is 10ms celling (thats why there is Update() method).
- * This concept is similar to TCP_CORK, but TCP_CORK
+ * For output the class uses a lock-free multi producer, single
+ * consumer queue of packets. SendPacket() may be called from any
+ * thread (world, map updaters, the socket's own network thread),
+ * it only copies the packet into a node and links it at the head
+ * of the queue, no mutex is taken. The network thread owning the
+ * socket is the only consumer: it encrypts the headers in queue
+ * order and hands as many queued packets as fit in one
+ * writev/sendmsg call (up to Network.OutUBuff bytes) to the kernel.
+ * The socket is not immediately activated for output when a packet
+ * is queued, there is 10ms celling (thats why there is Update()
+ * method). This concept is similar to TCP_CORK, but TCP_CORK
  * uses 200ms celling. As result overhead generated by
  * sending packets from "producer" threads is minimal,
- * and doing a lot of writes with small size is tolerated.
+ * and there is one send syscall per socket and update instead of
+ * one per packet.
  *
  * The calls to Update() method are managed by WorldSocketMgr
  * and ReactorRunnable.
  *
- * For input ,the class uses one 1024 bytes buffer on stack
+ * For input ,the class uses one buffer per connection (Network.InUBuff)
  * to which it does recv() calls. And then received data is
- * distributed where its needed. 1024 matches pretty well the
- * traffic generated by client for now.
+ * distributed where its needed.
+ *
+ * The socket is driven either by an ACE reactor, or with
+ * Network.Backend = 1 on Linux by the edge-triggered epoll loop of its
+ * network thread (m_EpollThread), which then calls handle_input and
+ * handle_output itself.
  *
  * The input/output do speculative reads/writes (AKA it tryes
  * to read all data available in the kernel buffer or tryes to
@@ -94,9 +111,6 @@ class WorldSocket : protected WorldHandler
         typedef ACE_Thread_Mutex LockType;
         typedef ACE_Guard<LockType> GuardType;
 
-        // Queue for storing packets for which there is no space.
-        typedef ACE_Unbounded_Queue< WorldPacket* > PacketQueueT;
-
         // Check if socket is closed.
         bool IsClosed (void) const;
 
@@ -106,7 +120,7 @@ class WorldSocket : protected WorldHandler
         // Get address of connected peer.
         const std::string& GetRemoteAddress (void) const;
 
-        // Send A packet on the socket, this function is reentrant.
+        // Send A packet on the socket, this function is reentrant and lock free.
         // pct packet to send
         // return -1 of failure
         int SendPacket (const WorldPacket& pct);
@@ -148,9 +162,13 @@ class WorldSocket : protected WorldHandler
         int handle_input_missing_data (void);
 
         // Help functions to mark/unmark the socket for output.
-        // param g the guard is for m_OutBufferLock, the function will release it
-        int cancel_wakeup_output (GuardType& g);
-        int schedule_wakeup_output (GuardType& g);
+        // Only called from the network thread.
+        int cancel_wakeup_output (void);
+        int schedule_wakeup_output (void);
+
+        // Token bucket of the opcode if it is protected: 0 to accept the packet,
+        // 1 to drop it, -1 to close the socket. Called with the decrypted header.
+        int CheckOpcodeRate (uint16 opcode);
 
         // process one incoming packet.
         // param new_pct received packet ,note that you need to delete it.
@@ -162,15 +180,19 @@ class WorldSocket : protected WorldHandler
         // Called by ProcessIncoming() on CMSG_PING.
         int HandlePing (WorldPacket& recvPacket);
 
-        // Try to write WorldPacket to m_OutBuffer ,return -1 if no space
-        // Need to be called with m_OutBufferLock lock held
-        int iSendPacket (const WorldPacket& pct);
+        // Link a node at the head of the send queue, called by any thread.
+        void PushSendQueue (WorldSocketSendNode* node);
+
+        // Unlink the oldest node of the send queue, NULL if empty or if
+        // a producer is still linking it. Only called from the network thread.
+        WorldSocketSendNode* PopSendQueue (void);
+
+        // Encrypt the headers of the packets in the send queue and move them
+        // to the output queue. Only called from the network thread.
+        void FlushSendQueue (void);
 
-        // Flush m_PacketQueue if there are packets in it
-        // Need to be called with m_OutBufferLock lock held
-        // return true if it wrote to the buffer (AKA you need
-        // to mark the socket for output).
-        bool iFlushPacketQueue ();
+        // True if something waits in the send or output queue.
+        bool HasPendingOutput (void) const;
 
     private:
         // Time in which the last ping was received
@@ -202,18 +224,45 @@ class WorldSocket : protected WorldHandler
         // Fragment of the received header.
         ACE_Message_Block m_Header;
 
-        // Mutex for protecting output related data.
-        LockType m_OutBufferLock;
-
-        // Buffer used for writing output.
-        ACE_Message_Block* m_OutBuffer;
-
-        // Size of the m_OutBuffer.
+        // Payload of a packet dropped by CheckOpcodeRate, read and thrown away
+        // without building a WorldPacket.
+        bool m_SkipPacket;
+        size_t m_SkipPayload;
+
+        // Rate limit state of the protected opcodes, by World::GetProtectedOpcodeSlot.
+        struct OpcodeBucket
+        {
+            OpcodeBucket() : tokens(0), lastRefill(0) {}
+
+            uint32 tokens;
+            uint64 lastRefill;
+        };
+        std::vector<OpcodeBucket> m_OpcodeBuckets;
+
+        // Mutex for closing the socket from several threads.
+        LockType m_CloseLock;
+
+        // Send queue: producers exchange m_SendQueueHead, the network thread
+        // reads from m_SendQueueTail. m_SendQueueStub keeps the queue non empty.
+        std::atomic<WorldSocketSendNode*> m_SendQueueHead;
+        WorldSocketSendNode* m_SendQueueTail;
+        WorldSocketSendNode m_SendQueueStub;
+
+        // Output queue: packets with encrypted headers, waiting for the kernel.
+        // m_OutQueueSent bytes of the first one were already sent.
+        WorldSocketSendNode* m_OutQueueHead;
+        WorldSocketSendNode* m_OutQueueTail;
+        size_t m_OutQueueSent;
+
+        // Max bytes handed to the kernel in one send call.
         size_t m_OutBufferSize;
 
-        // Here are stored packets for which there was no space on m_OutBuffer,
-        // this allows not-to kick player if its buffer is overflowed.
-        PacketQueueT m_PacketQueue;
+        // Buffer for recv() calls.
+        char* m_InBuffer;
+        size_t m_InBufferSize;
+
+        // Network thread polling this socket with epoll, NULL with the ACE reactor.
+        ReactorRunnable* m_EpollThread;
 
         // True if the socket is registered with the reactor for output
         bool m_OutActive;
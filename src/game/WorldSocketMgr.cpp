@@ -32,11 +32,17 @@
 
 #include <set>
 
+#if defined (ACE_HAS_EVENT_POLL)
+#include <sys/epoll.h>
+#define WORLDSOCKET_EPOLL
+#endif
+
 #include "Log.h"
 #include "Common.h"
 #include "Config/Config.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldSocket.h"
+#include "Timer.h"
 
 /**
 * This is a helper class to WorldSocketMgr ,that manages
@@ -50,7 +56,10 @@ class ReactorRunnable : protected ACE_Task_Base
         ReactorRunnable() :
             m_Reactor(0),
             m_Connections(0),
-            m_ThreadId(-1)
+            m_ThreadId(-1),
+            m_Epoll(ACE_INVALID_HANDLE),
+            m_Listener(ACE_INVALID_HANDLE),
+            m_EpollStop(false)
         {
             ACE_Reactor_Impl* imp = 0;
 
@@ -77,13 +86,73 @@ class ReactorRunnable : protected ACE_Task_Base
             Wait();
 
             delete m_Reactor;
+
+            if (m_Listener != ACE_INVALID_HANDLE)
+                ACE_OS::closesocket (m_Listener);
+
+            if (m_Epoll != ACE_INVALID_HANDLE)
+                ACE_OS::close (m_Epoll);
         }
 
         void Stop()
         {
+            m_EpollStop = true;
             m_Reactor->end_reactor_event_loop();
         }
 
+        #ifdef WORLDSOCKET_EPOLL
+        // Switch this thread to the native backend: an edge-triggered epoll loop
+        // accepting from its own SO_REUSEPORT listener, the kernel spreads the
+        // connections over the network threads.
+        int OpenEpoll (const ACE_INET_Addr& listen_addr)
+        {
+            m_Epoll = epoll_create1 (EPOLL_CLOEXEC);
+
+            if (m_Epoll == ACE_INVALID_HANDLE)
+            {
+                sLog.outError ("ReactorRunnable::OpenEpoll: epoll_create1 errno = %s", ACE_OS::strerror (errno));
+                return -1;
+            }
+
+            m_Listener = ACE_OS::socket (listen_addr.get_type(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+            if (m_Listener == ACE_INVALID_HANDLE)
+            {
+                sLog.outError ("ReactorRunnable::OpenEpoll: socket errno = %s", ACE_OS::strerror (errno));
+                return -1;
+            }
+
+            int one = 1;
+
+            if (ACE_OS::setsockopt (m_Listener, SOL_SOCKET, SO_REUSEADDR, (const char*) &one, sizeof (one)) == -1 ||
+                ACE_OS::setsockopt (m_Listener, SOL_SOCKET, SO_REUSEPORT, (const char*) &one, sizeof (one)) == -1)
+            {
+                sLog.outError ("ReactorRunnable::OpenEpoll: SO_REUSEPORT errno = %s", ACE_OS::strerror (errno));
+                return -1;
+            }
+
+            if (ACE_OS::bind (m_Listener, (sockaddr*) listen_addr.get_addr(), listen_addr.get_size()) == -1 ||
+                ACE_OS::listen (m_Listener, ACE_DEFAULT_BACKLOG) == -1)
+            {
+                sLog.outError ("ReactorRunnable::OpenEpoll: bind/listen errno = %s", ACE_OS::strerror (errno));
+                return -1;
+            }
+
+            // data.ptr NULL marks the listener
+            epoll_event ev;
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.ptr = NULL;
+
+            if (epoll_ctl (m_Epoll, EPOLL_CTL_ADD, m_Listener, &ev) == -1)
+            {
+                sLog.outError ("ReactorRunnable::OpenEpoll: epoll_ctl errno = %s", ACE_OS::strerror (errno));
+                return -1;
+            }
+
+            return 0;
+        }
+        #endif
+
         int Start()
         {
             if (m_ThreadId != -1)
@@ -108,7 +177,8 @@ class ReactorRunnable : protected ACE_Task_Base
 
             ++m_Connections;
             sock->AddReference();
-            sock->reactor (m_Reactor);
+            if (m_Epoll == ACE_INVALID_HANDLE)
+                sock->reactor (m_Reactor);
             m_NewSockets.insert (sock);
 
             return 0;
@@ -120,6 +190,7 @@ class ReactorRunnable : protected ACE_Task_Base
         }
 
     protected:
+        typedef std::set<WorldSocket*> SocketSet;
 
         void AddNewSockets()
         {
@@ -137,6 +208,12 @@ class ReactorRunnable : protected ACE_Task_Base
                     sock->RemoveReference();
                     --m_Connections;
                 }
+                else if (!RegisterEpoll (sock))
+                {
+                    sock->CloseSocket();
+                    sock->RemoveReference();
+                    --m_Connections;
+                }
                 else
                     m_Sockets.insert (sock);
             }
@@ -144,6 +221,145 @@ class ReactorRunnable : protected ACE_Task_Base
             m_NewSockets.clear();
         }
 
+        // Update() all sockets, closes the ones that failed
+        void UpdateSockets()
+        {
+            for (SocketSet::iterator i = m_Sockets.begin(); i != m_Sockets.end();)
+            {
+                if ((*i)->Update() == -1)
+                {
+                    SocketSet::iterator t = i;
+                    ++i;
+                    RemoveSocket (t);
+                }
+                else
+                    ++i;
+            }
+        }
+
+        void RemoveSocket (SocketSet::iterator itr)
+        {
+            WorldSocket* sock = *itr;
+
+            #ifdef WORLDSOCKET_EPOLL
+            if (m_Epoll != ACE_INVALID_HANDLE)
+                epoll_ctl (m_Epoll, EPOLL_CTL_DEL, sock->get_handle(), NULL);
+            #endif
+
+            sock->CloseSocket();
+            sock->RemoveReference();
+            --m_Connections;
+            m_Sockets.erase (itr);
+        }
+
+        bool RegisterEpoll (WorldSocket* sock)
+        {
+            #ifdef WORLDSOCKET_EPOLL
+            if (m_Epoll == ACE_INVALID_HANDLE)
+                return true;
+
+            // EPOLLOUT fires once right away, which flushes SMSG_AUTH_CHALLENGE
+            epoll_event ev;
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.ptr = sock;
+
+            if (epoll_ctl (m_Epoll, EPOLL_CTL_ADD, sock->get_handle(), &ev) == -1)
+            {
+                sLog.outError ("ReactorRunnable::RegisterEpoll: epoll_ctl errno = %s", ACE_OS::strerror (errno));
+                return false;
+            }
+            #else
+            ACE_UNUSED_ARG (sock);
+            #endif
+
+            return true;
+        }
+
+        #ifdef WORLDSOCKET_EPOLL
+        // accept until the backlog is empty, the sockets stay on this thread
+        void AcceptSockets()
+        {
+            while (true)
+            {
+                ACE_HANDLE handle = accept4 (m_Listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+                if (handle == ACE_INVALID_HANDLE)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                        continue;
+
+                    if (errno != EWOULDBLOCK && errno != EAGAIN)
+                        sLog.outError ("ReactorRunnable::AcceptSockets: accept4 errno = %s", ACE_OS::strerror (errno));
+
+                    return;
+                }
+
+                WorldSocket* sock;
+                ACE_NEW (sock, WorldSocket);
+
+                sock->peer().set_handle (handle);
+                sock->m_EpollThread = this;
+
+                // open() hands the socket to AddSocket of this thread
+                if (sock->open (NULL) == -1)
+                    sock->close (0);
+            }
+        }
+
+        void EpollLoop()
+        {
+            epoll_event events[256];
+            uint32 lastUpdate = getMSTime();
+
+            while (!m_EpollStop)
+            {
+                int n = epoll_wait (m_Epoll, events, 256, 10);
+
+                if (n == -1 && errno != EINTR)
+                {
+                    sLog.outError ("ReactorRunnable::EpollLoop: epoll_wait errno = %s", ACE_OS::strerror (errno));
+                    break;
+                }
+
+                for (int e = 0; e < n; ++e)
+                {
+                    WorldSocket* sock = static_cast<WorldSocket*> (events[e].data.ptr);
+
+                    if (!sock)
+                    {
+                        AcceptSockets();
+                        continue;
+                    }
+
+                    int result = 0;
+
+                    // a short read means the kernel buffer is drained, the next data raises a new edge
+                    if (events[e].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                        while ((result = sock->handle_input()) == 1);
+
+                    if (result != -1 && (events[e].events & EPOLLOUT))
+                        result = sock->handle_output();
+
+                    if (result == -1)
+                    {
+                        SocketSet::iterator itr = m_Sockets.find (sock);
+                        if (itr != m_Sockets.end())
+                            RemoveSocket (itr);
+                    }
+                }
+
+                AddNewSockets();
+
+                // same 10ms output celling as with the reactor
+                if (getMSTimeDiff (lastUpdate, getMSTime()) >= 10)
+                {
+                    lastUpdate = getMSTime();
+                    UpdateSockets();
+                }
+            }
+        }
+        #endif
+
         virtual int svc()
         {
             DEBUG_LOG ("Network Thread Starting");
@@ -152,7 +368,18 @@ class ReactorRunnable : protected ACE_Task_Base
 
             ACE_ASSERT (m_Reactor);
 
-            SocketSet::iterator i, t;
+            #ifdef WORLDSOCKET_EPOLL
+            if (m_Epoll != ACE_INVALID_HANDLE)
+            {
+                EpollLoop();
+
+                WorldDatabase.ThreadEnd();
+
+                DEBUG_LOG ("Network Thread Exitting");
+
+                return 0;
+            }
+            #endif
 
             while (!m_Reactor->reactor_event_loop_done())
             {
@@ -165,20 +392,7 @@ class ReactorRunnable : protected ACE_Task_Base
 
                 AddNewSockets();
 
-                for (i = m_Sockets.begin(); i != m_Sockets.end();)
-                {
-                    if ((*i)->Update() == -1)
-                    {
-                        t = i;
-                        ++i;
-                        (*t)->CloseSocket();
-                        (*t)->RemoveReference();
-                        --m_Connections;
-                        m_Sockets.erase (t);
-                    }
-                    else
-                        ++i;
-                }
+                UpdateSockets();
             }
 
             WorldDatabase.ThreadEnd();
@@ -190,12 +404,16 @@ class ReactorRunnable : protected ACE_Task_Base
 
     private:
         typedef ACE_Atomic_Op<ACE_SYNCH_MUTEX, long> AtomicInt;
-        typedef std::set<WorldSocket*> SocketSet;
 
         ACE_Reactor* m_Reactor;
         AtomicInt m_Connections;
         int m_ThreadId;
 
+        // native backend, m_Epoll is ACE_INVALID_HANDLE with the ACE reactor
+        ACE_HANDLE m_Epoll;
+        ACE_HANDLE m_Listener;
+        volatile bool m_EpollStop;
+
         SocketSet m_Sockets;
 
         SocketSet m_NewSockets;
@@ -207,6 +425,7 @@ WorldSocketMgr::WorldSocketMgr() :
     m_NetThreadsCount(0),
     m_SockOutKBuff(-1),
     m_SockOutUBuff(65536),
+    m_SockInUBuff(16384),
     m_UseNoDelay(true),
     m_Acceptor (0)
 {
@@ -248,6 +467,23 @@ WorldSocketMgr::StartReactiveIO (ACE_UINT16 port, const char* address)
         return -1;
     }
 
+    m_SockInUBuff = sConfig.GetIntDefault ("Network.InUBuff", 16384);
+
+    if (m_SockInUBuff < 1024)
+    {
+        sLog.outError ("Network.InUBuff is wrong in your config file");
+        return -1;
+    }
+
+    if (sConfig.GetIntDefault ("Network.Backend", 0) == 1)
+    {
+        #ifdef WORLDSOCKET_EPOLL
+        return StartEpollIO (port, address);
+        #else
+        sLog.outError ("Network.Backend = 1 needs epoll, using the ACE reactor");
+        #endif
+    }
+
     WorldSocket::Acceptor* acc = new WorldSocket::Acceptor;
     m_Acceptor = acc;
 
@@ -265,6 +501,35 @@ WorldSocketMgr::StartReactiveIO (ACE_UINT16 port, const char* address)
     return 0;
 }
 
+int
+WorldSocketMgr::StartEpollIO (ACE_UINT16 port, const char* address)
+{
+    #ifdef WORLDSOCKET_EPOLL
+    sLog.outBasic ("Using the epoll network backend");
+
+    ACE_INET_Addr listen_addr (port, address);
+
+    // every network thread accepts for itself, m_NetThreads[0] (the ACE acceptor thread) stays idle
+    for (size_t i = 1; i < m_NetThreadsCount; ++i)
+    {
+        if (m_NetThreads[i].OpenEpoll (listen_addr) == -1)
+        {
+            sLog.outError ("Failed to open the epoll listener ,check if the port is free");
+            return -1;
+        }
+    }
+
+    for (size_t i = 1; i < m_NetThreadsCount; ++i)
+        m_NetThreads[i].Start();
+
+    return 0;
+    #else
+    ACE_UNUSED_ARG (port);
+    ACE_UNUSED_ARG (address);
+    return -1;
+    #endif
+}
+
 int
 WorldSocketMgr::StartNetwork (ACE_UINT16 port, const char* address)
 {
@@ -339,6 +604,11 @@ WorldSocketMgr::OnSocketOpen (WorldSocket* sock)
     }
 
     sock->m_OutBufferSize = static_cast<size_t> (m_SockOutUBuff);
+    sock->m_InBufferSize = static_cast<size_t> (m_SockInUBuff);
+
+    // with epoll the thread that accepted the socket keeps it
+    if (sock->m_EpollThread)
+        return sock->m_EpollThread->AddSocket (sock);
 
     // we skip the Acceptor Thread
     size_t min = 1;
@@ -49,6 +49,7 @@ class WorldSocketMgr
         int OnSocketOpen(WorldSocket* sock);
 
         int StartReactiveIO(ACE_UINT16 port, const char* address);
+        int StartEpollIO(ACE_UINT16 port, const char* address);
 
     private:
         WorldSocketMgr();
@@ -59,6 +60,7 @@ class WorldSocketMgr
 
         int m_SockOutKBuff;
         int m_SockOutUBuff;
+        int m_SockInUBuff;
         bool m_UseNoDelay;
 
         ACE_Event_Handler* m_Acceptor;
@@ -24,6 +24,7 @@
 #include "MapManager.h"
 #include "BattlegroundMgr.h"
 #include "CreatureGroups.h"
+#include "ObjectMgr.h"
 
 #include "Database/DatabaseEnv.h"
 
@@ -76,6 +77,8 @@ void WorldRunnable::run()
 
     MapManager::Instance().UnloadAll();                     // unload all grids (including locked in memory)
 
+    sObjectMgr.SaveRespawnTimes();                          // write respawn times collected since the last world update
+
     // End the database thread
     WorldDatabase.ThreadEnd();                                  // free mySQL thread resources
 }
@@ -417,6 +417,80 @@ QueryResult_AutoPtr Database::PQuery(const char* format, ...)
     return Query(szQuery);
 }
 
+/**
+  * @brief Runs a query whose rows are streamed from the server instead of
+  * being buffered client side first.
+  * Meant for loading big tables: memory use stays at one row no matter
+  * how many rows the table has.
+  *
+  * @note Holds the connection until the result was read to the end or
+  * released, async statements of this database wait for it meanwhile.
+  * Returns NULL when the query fails or has no rows, just like Query.
+  */
+StreamedQueryResult_AutoPtr Database::StreamQuery(const char* sql)
+{
+    if (!mMysql)
+        return StreamedQueryResult_AutoPtr(NULL);
+
+    // released by the result once it is exhausted or destroyed
+    mMutex.acquire();
+
+    #ifdef OREGON_DEBUG
+    uint32 _s = getMSTime();
+    #endif
+    if (mysql_query(mMysql, sql))
+    {
+        sLog.outErrorDb("SQL: %s", sql);
+        sLog.outErrorDb("query ERROR: %s", mysql_error(mMysql));
+        mMutex.release();
+        return StreamedQueryResult_AutoPtr(NULL);
+    }
+    #ifdef OREGON_DEBUG
+    // prevent recursive death
+    unsigned long oldMask = sLog.GetDBLogMask();
+    sLog.SetDBLogMask(oldMask & ~(1 << LOG_TYPE_DEBUG));
+    sLog.outDebug("[%u ms] SQL (streamed): %s", getMSTimeDiff(_s, getMSTime()), sql);
+    sLog.SetDBLogMask(oldMask);
+    #endif
+
+    MYSQL_RES* result = mysql_use_result(mMysql);
+    if (!result)
+    {
+        mMutex.release();
+        return StreamedQueryResult_AutoPtr(NULL);
+    }
+
+    StreamedQueryResult* queryResult = new StreamedQueryResult(mMysql, result, mysql_fetch_fields(result), mysql_field_count(mMysql), &mMutex);
+
+    if (!queryResult->NextRow())
+    {
+        delete queryResult;
+        return StreamedQueryResult_AutoPtr(NULL);
+    }
+
+    return StreamedQueryResult_AutoPtr(queryResult);
+}
+
+StreamedQueryResult_AutoPtr Database::PStreamQuery(const char* format, ...)
+{
+    if (!format)
+        return StreamedQueryResult_AutoPtr(NULL);
+
+    va_list ap;
+    char szQuery [MAX_QUERY_LEN];
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return StreamedQueryResult_AutoPtr(NULL);
+    }
+
+    return StreamQuery(szQuery);
+}
+
 bool Database::Execute(const char* sql)
 {
     if (!mMysql)
@@ -67,6 +67,10 @@ class Database
         QueryResult_AutoPtr Query(const char* sql);
         QueryResult_AutoPtr PQuery(const char* format, ...) ATTR_PRINTF(2, 3);
 
+        // Unbuffered queries for bulk loads, see StreamedQueryResult
+        StreamedQueryResult_AutoPtr StreamQuery(const char* sql);
+        StreamedQueryResult_AutoPtr PStreamQuery(const char* format, ...) ATTR_PRINTF(2, 3);
+
         bool ExecuteFile(const char* file);
 
         // Async queries and query holders, implemented in DatabaseImpl.h
@@ -25,7 +25,7 @@ class Field
 {
     public:
 
-        Field() : mValue(NULL), mType(MYSQL_TYPE_NULL) {}
+        Field() : mValue(NULL), mType(MYSQL_TYPE_NULL), mIsRawValue(false) {}
 
         ~Field()
         {
@@ -110,14 +110,14 @@ class Field
 
         GetIntegerDataImpl(GetFloat,  MYSQL_TYPE_FLOAT,      float,  STRTOF(mValue,   NULL))
         GetIntegerDataImpl(GetDouble, MYSQL_TYPE_DOUBLE,     double, strtod(mValue,   NULL))
-        GetIntegerDataImpl(GetInt8,   MYSQL_TYPE_TINY,       int8,   strtol(mValue,   NULL, 10))
-        GetIntegerDataImpl(GetInt16,  MYSQL_TYPE_SHORT,      int16,  strtol(mValue,   NULL, 10))
-        GetIntegerDataImpl(GetInt32,  MYSQL_TYPE_LONG,       int32,  strtol(mValue,   NULL, 10))
-        GetIntegerDataImpl(GetInt64,  MYSQL_TYPE_LONGLONG,   int64,  strtoll(mValue,  NULL, 10))
-        GetIntegerDataImpl(GetUInt8,  MYSQL_TYPE_TINY,       uint8,  strtoul(mValue,  NULL, 10))
-        GetIntegerDataImpl(GetUInt16, MYSQL_TYPE_SHORT,      uint16, strtoul(mValue,  NULL, 10))
-        GetIntegerDataImpl(GetUInt32, MYSQL_TYPE_LONG,       uint32, strtoul(mValue,  NULL, 10))
-        GetIntegerDataImpl(GetUInt64, MYSQL_TYPE_LONGLONG,   uint64, strtoull(mValue, NULL, 10))
+        GetIntegerDataImpl(GetInt8,   MYSQL_TYPE_TINY,       int8,   ParseSigned())
+        GetIntegerDataImpl(GetInt16,  MYSQL_TYPE_SHORT,      int16,  ParseSigned())
+        GetIntegerDataImpl(GetInt32,  MYSQL_TYPE_LONG,       int32,  ParseSigned())
+        GetIntegerDataImpl(GetInt64,  MYSQL_TYPE_LONGLONG,   int64,  ParseSigned())
+        GetIntegerDataImpl(GetUInt8,  MYSQL_TYPE_TINY,       uint8,  ParseUnsigned())
+        GetIntegerDataImpl(GetUInt16, MYSQL_TYPE_SHORT,      uint16, ParseUnsigned())
+        GetIntegerDataImpl(GetUInt32, MYSQL_TYPE_LONG,       uint32, ParseUnsigned())
+        GetIntegerDataImpl(GetUInt64, MYSQL_TYPE_LONGLONG,   uint64, ParseUnsigned())
 
         #undef GetIntegerDataImpl 
         #undef dbg_help_var
@@ -153,6 +153,52 @@ class Field
         Field(Field const&);
         Field& operator=(Field const&);
 
+        /// Text values of integer columns are plain decimal digits, so they are
+        /// converted inline; anything else (fractions, exponents, blanks) falls
+        /// back to the locale aware strto* family.
+        int64 ParseSigned() const
+        {
+            const char* itr = mValue;
+            bool negative = *itr == '-';
+            if (negative)
+                ++itr;
+
+            uint64 value = 0;
+            for (const char* digit = itr; ; ++digit)
+            {
+                if (*digit >= '0' && *digit <= '9')
+                    value = value * 10 + (*digit - '0');
+                else if (*digit || digit == itr || digit - itr > 18)
+                    return strtoll(mValue, NULL, 10);
+                else
+                    break;
+            }
+
+            return negative ? -int64(value) : int64(value);
+        }
+
+        uint64 ParseUnsigned() const
+        {
+            const char* itr = mValue;
+            bool negative = *itr == '-';
+            if (negative)
+                ++itr;
+
+            uint64 value = 0;
+            for (const char* digit = itr; ; ++digit)
+            {
+                if (*digit >= '0' && *digit <= '9')
+                    value = value * 10 + (*digit - '0');
+                else if (*digit || digit == itr || digit - itr > 19)
+                    return strtoull(mValue, NULL, 10);
+                else
+                    break;
+            }
+
+            // same wrap around as strtoull for negative input
+            return negative ? uint64(0) - value : value;
+        }
+
         union
         {
             /// data and size (prepared statements)
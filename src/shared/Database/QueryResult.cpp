@@ -177,6 +177,70 @@ void QueryResult::EndQuery()
         mResult = 0;
     }
 }
+
+StreamedQueryResult::StreamedQueryResult(MYSQL* connection, MYSQL_RES* result, MYSQL_FIELD* fields, uint32 fieldCount, ACE_Thread_Mutex* connectionLock)
+    : mFieldCount(fieldCount)
+    , mRowCount(0)
+    , mFields(fields)
+    , mConnection(connection)
+    , mResult(result)
+    , mConnectionLock(connectionLock)
+{
+    mCurrentRow = new Field[mFieldCount];
+    ASSERT(mCurrentRow);
+
+    for (uint32 i = 0; i < mFieldCount; i++)
+        mCurrentRow[i].SetType(fields[i].type);
+}
+
+StreamedQueryResult::~StreamedQueryResult()
+{
+    EndQuery();
+}
+
+bool StreamedQueryResult::NextRow()
+{
+    if (!mResult)
+        return false;
+
+    MYSQL_ROW row = mysql_fetch_row(mResult);
+    if (!row)
+    {
+        if (mysql_errno(mConnection))
+            sLog.outErrorDb("StreamedQueryResult: fetching row %lu failed: %s", (unsigned long)mRowCount, mysql_error(mConnection));
+
+        EndQuery();
+        return false;
+    }
+
+    for (uint32 i = 0; i < mFieldCount; i++)
+        mCurrentRow[i].SetValue(row[i]);
+
+    ++mRowCount;
+    return true;
+}
+
+void StreamedQueryResult::EndQuery()
+{
+    if (mCurrentRow)
+    {
+        delete [] mCurrentRow;
+        mCurrentRow = 0;
+    }
+
+    // unread rows are drained from the connection here
+    if (mResult)
+    {
+        mysql_free_result(mResult);
+        mResult = 0;
+    }
+
+    if (mConnectionLock)
+    {
+        mConnectionLock->release();
+        mConnectionLock = 0;
+    }
+}
 #if 0
 enum Field::DataTypes QueryResult::ConvertNativeType(enum_field_types mysqlType) const
 {
@@ -20,6 +20,7 @@
 
 #include <ace/Refcounted_Auto_Ptr.h>
 #include <ace/Null_Mutex.h>
+#include <ace/Thread_Mutex.h>
 #include <stdexcept>
 
 #include "Field.h"
@@ -69,6 +70,44 @@ class QueryResult
         MYSQL_RES* mResult;
 };
 
+/**
+  * @brief Unbuffered result of a plain query (mysql_use_result).
+  * Rows are pulled from the server one at a time, so reading a huge table
+  * doesn't require the whole result set to be held in client memory.
+  *
+  * @note The connection stays locked until the last row was read or the
+  * result is destroyed. Don't run other queries on the same database while
+  * iterating (escaping strings is fine).
+  */
+class StreamedQueryResult
+{
+    public:
+        StreamedQueryResult(MYSQL* connection, MYSQL_RES* result, MYSQL_FIELD* fields, uint32 fieldCount, ACE_Thread_Mutex* connectionLock);
+        ~StreamedQueryResult();
+
+        bool NextRow();
+
+        Field* Fetch() const { return mCurrentRow; }
+        Field const& operator [] (int index) const { return mCurrentRow[index]; }
+
+        uint32 GetFieldCount() const { return mFieldCount; }
+        /// Rows read so far, the total isn't known until the result is exhausted
+        uint64 GetRowCount() const { return mRowCount; }
+
+    protected:
+        Field* mCurrentRow;
+        uint32 mFieldCount;
+        uint64 mRowCount;
+        MYSQL_FIELD* mFields;
+
+    private:
+        void EndQuery();
+
+        MYSQL* mConnection;
+        MYSQL_RES* mResult;
+        ACE_Thread_Mutex* mConnectionLock;
+};
+
 class PreparedQueryResult
 {
     public:
@@ -111,6 +150,7 @@ class PreparedQueryResult
 };
 
 typedef ACE_Refcounted_Auto_Ptr<QueryResult, ACE_Null_Mutex> QueryResult_AutoPtr;
+typedef ACE_Refcounted_Auto_Ptr<StreamedQueryResult, ACE_Null_Mutex> StreamedQueryResult_AutoPtr;
 typedef ACE_Refcounted_Auto_Ptr<PreparedQueryResult, ACE_Null_Mutex> PreparedQueryResult_AutoPtr;
 
 #endif
@@ -20,8 +20,14 @@
 #include <stdio.h>
 #include <deque>
 #include <set>
+#include <map>
 #include <cstdlib>
 
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <ace/OS_NS_unistd.h>
+
 #ifdef WIN32
 #include "direct.h"
 #else
@@ -66,6 +72,7 @@ uint16 *LiqType;
 char output_path[MAX_PATH_LENGTH] = ".";
 char input_path[MAX_PATH_LENGTH] = ".";
 uint32 maxAreaId = 0;
+uint32 maxLiqTypeId = 0;
 
 // **************************************************
 // Extractor options
@@ -91,6 +98,11 @@ float CONF_float_to_int16_limit = 2048.0f;   // Max accuracy = val/65536
 float CONF_flat_height_delta_limit = 0.005f; // If max - min less this value - surface is flat
 float CONF_flat_liquid_delta_limit = 0.001f; // If max - min less this value - liquid surface is flat
 
+// Number of threads converting adt files, 0 - one per processor
+int   CONF_threads = 0;
+// Only convert tiles whose source data changed since the last extraction
+bool  CONF_incremental = false;
+
 // List MPQ for extract from
 const char *CONF_mpq_list[]={
     "common.MPQ",
@@ -137,6 +149,8 @@ void Usage(char* prg)
         "-o set output path (max %d characters)\n"\
         "-e extract only MAP(1)/DBC(2)/Camera(4) - standard: all(7)\n"\
         "-f height stored as int (less map size but lost some accuracy) 1 by default\n"\
+        "-t number of threads converting map tiles - standard: one per processor\n"\
+        "-u only convert map tiles whose source changed since the last extraction 0 by default\n"\
         "Example: %s -f 0 -i \"c:\\games\\game\"", prg, MAX_PATH_LENGTH - 1, MAX_PATH_LENGTH - 1, prg);
     exit(1);
 }
@@ -150,6 +164,8 @@ void HandleArgs(int argc, char* arg[])
         // e - extract only MAP(1)/DBC(2) - standard both(3)
         // f - use float to int conversion
         // h - limit minimum height
+        // t - number of converter threads
+        // u - incremental map extraction
         if (arg[c][0] != '-')
             Usage(arg[0]);
 
@@ -173,6 +189,18 @@ void HandleArgs(int argc, char* arg[])
             else
                 Usage(arg[0]);
             break;
+        case 't':
+            if (c + 1 < argc)                           // all ok
+                CONF_threads = atoi(arg[(c++) + 1]);
+            else
+                Usage(arg[0]);
+            break;
+        case 'u':
+            if (c + 1 < argc)                           // all ok
+                CONF_incremental = atoi(arg[(c++) + 1]) != 0;
+            else
+                Usage(arg[0]);
+            break;
         case 'e':
             if (c + 1 < argc)                           // all ok
             {
@@ -288,6 +316,8 @@ void ReadLiquidTypeTableDBC()
     for (uint32 x = 0; x < LiqType_count; ++x)
         LiqType[dbc.getRecord(x).getUInt(0)] = dbc.getRecord(x).getUInt(3);
 
+    maxLiqTypeId = LiqType_maxid;
+
     printf("Done! (%lu LiqTypes loaded)\n", LiqType_count);
 }
 
@@ -372,27 +402,37 @@ float selectUInt16StepStore(float maxDiff)
 {
     return 65535 / maxDiff;
 }
-// Temporary grid data store
-uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-
-float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-float V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
-uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-uint16 uint16_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
-uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-uint8  uint8_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
-
-uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
-float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
-
-bool ConvertADT(char* filename, char* filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
+// Temporary grid data store, each converter thread has its own
+struct GridDataStore
 {
-    ADT_file adt;
+    uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+
+    float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+    float V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
+    uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+    uint16 uint16_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
+    uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+    uint8  uint8_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
+
+    uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+    uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+    bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
+    float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
+};
 
-    if (!adt.loadFile(filename))
-        return false;
+bool ConvertADT(ADT_file& adt, char const* filename, char const* filename2, GridDataStore& store, uint32 build)
+{
+    uint16 (&area_flags)[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID] = store.area_flags;
+    float (&V8)[ADT_GRID_SIZE][ADT_GRID_SIZE] = store.V8;
+    float (&V9)[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1] = store.V9;
+    uint16 (&uint16_V8)[ADT_GRID_SIZE][ADT_GRID_SIZE] = store.uint16_V8;
+    uint16 (&uint16_V9)[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1] = store.uint16_V9;
+    uint8 (&uint8_V8)[ADT_GRID_SIZE][ADT_GRID_SIZE] = store.uint8_V8;
+    uint8 (&uint8_V9)[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1] = store.uint8_V9;
+    uint16 (&liquid_entry)[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID] = store.liquid_entry;
+    uint8 (&liquid_flags)[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID] = store.liquid_flags;
+    bool (&liquid_show)[ADT_GRID_SIZE][ADT_GRID_SIZE] = store.liquid_show;
+    float (&liquid_height)[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1] = store.liquid_height;
 
     adt_MCIN* cells = adt.a_grid->getMCIN();
     if (!cells)
@@ -888,6 +928,9 @@ bool ConvertADT(char* filename, char* filename2, int /*cell_y*/, int /*cell_x*/,
         return false;
     }
 
+    // buffer the whole file, it is written out with a single call on fclose
+    setvbuf(output, NULL, _IOFBF, map.holesOffset + map.holesSize);
+
     fwrite(&map, sizeof(map), 1, output);
     // Store area data
     fwrite(&areaHeader, sizeof(areaHeader), 1, output);
@@ -940,6 +983,159 @@ bool ConvertADT(char* filename, char* filename2, int /*cell_y*/, int /*cell_x*/,
     return true;
 }
 
+//
+// Parallel adt conversion: the main thread reads adt files from the MPQs
+// (libmpq is not thread safe) and converter threads turn them into .map files
+//
+
+struct ADTConvertJob
+{
+    ADT_file* adt;
+    std::string mpqName;
+    std::string outputName;
+    uint32 tileKey;
+    uint64 sourceHash;
+};
+
+// Bounded job queue, keeps the reader from loading far ahead of the converters
+class ADTConvertQueue
+{
+    public:
+        ADTConvertQueue(size_t maxSize) : _condition(_lock), _maxSize(maxSize), _closed(false) {}
+
+        void Push(ADTConvertJob* job)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+            while (_jobs.size() >= _maxSize)
+                _condition.wait();
+
+            _jobs.push_back(job);
+            _condition.broadcast();
+        }
+
+        // returns NULL once the queue is closed and empty
+        ADTConvertJob* Pop()
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, _lock, NULL);
+            while (_jobs.empty() && !_closed)
+                _condition.wait();
+
+            if (_jobs.empty())
+                return NULL;
+
+            ADTConvertJob* job = _jobs.front();
+            _jobs.pop_front();
+            _condition.broadcast();
+            return job;
+        }
+
+        void Close()
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, _lock);
+            _closed = true;
+            _condition.broadcast();
+        }
+
+    private:
+        ACE_Thread_Mutex _lock;
+        ACE_Condition_Thread_Mutex _condition;
+        std::deque<ADTConvertJob*> _jobs;
+        size_t _maxSize;
+        bool _closed;
+};
+
+// Hashes of the adt data the existing .map files were converted from, used by incremental extraction
+typedef std::map<uint32, uint64> SourceHashMap;
+SourceHashMap sourceHashes;
+ACE_Thread_Mutex sourceHashLock;
+
+uint64 HashData(uint64 hash, void const* data, size_t size)
+{
+    // FNV-1a
+    uint8 const* bytes = static_cast<uint8 const*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+std::string GetSourceHashFileName()
+{
+    return std::string(output_path) + "/maps.hashes";
+}
+
+void LoadSourceHashes()
+{
+    FILE* input = fopen(GetSourceHashFileName().c_str(), "rb");
+    if (!input)
+        return;
+
+    uint32 tileKey;
+    uint64 hash;
+    while (fread(&tileKey, sizeof(tileKey), 1, input) == 1 && fread(&hash, sizeof(hash), 1, input) == 1)
+        sourceHashes[tileKey] = hash;
+
+    fclose(input);
+}
+
+void SaveSourceHashes()
+{
+    std::string filename = GetSourceHashFileName();
+    FILE* output = fopen(filename.c_str(), "wb");
+    if (!output)
+    {
+        printf("Can't create the output file '%s'\n", filename.c_str());
+        return;
+    }
+
+    for (SourceHashMap::const_iterator itr = sourceHashes.begin(); itr != sourceHashes.end(); ++itr)
+    {
+        fwrite(&itr->first, sizeof(itr->first), 1, output);
+        fwrite(&itr->second, sizeof(itr->second), 1, output);
+    }
+
+    fclose(output);
+}
+
+class ADTConverter : public ACE_Task_Base
+{
+    public:
+        ADTConverter(ADTConvertQueue& queue, uint32 build) : _queue(queue), _build(build), _store(new GridDataStore())
+        {
+            activate();
+        }
+
+        ~ADTConverter()
+        {
+            delete _store;
+        }
+
+        int svc()
+        {
+            while (ADTConvertJob* job = _queue.Pop())
+            {
+                if (ConvertADT(*job->adt, job->mpqName.c_str(), job->outputName.c_str(), *_store, _build))
+                {
+                    ACE_Guard<ACE_Thread_Mutex> guard(sourceHashLock);
+                    sourceHashes[job->tileKey] = job->sourceHash;
+                }
+
+                delete job->adt;
+                delete job;
+            }
+
+            return 0;
+        }
+
+    private:
+        ADTConvertQueue& _queue;
+        uint32 _build;
+        GridDataStore* _store;
+};
+
 void ExtractMapsFromMpq(uint32 build)
 {
     char mpq_filename[1024];
@@ -957,7 +1153,32 @@ void ExtractMapsFromMpq(uint32 build)
     path += "/maps/";
     CreateDir(path);
 
-    printf("Convert map files\n");
+    // everything besides the adt itself that ends up in a .map file
+    uint64 settingsHash = 14695981039346656037ULL;
+    settingsHash = HashData(settingsHash, &build, sizeof(build));
+    settingsHash = HashData(settingsHash, &CONF_allow_float_to_int, sizeof(CONF_allow_float_to_int));
+    settingsHash = HashData(settingsHash, &CONF_allow_height_limit, sizeof(CONF_allow_height_limit));
+    settingsHash = HashData(settingsHash, areas, (maxAreaId + 1) * sizeof(uint16));
+    settingsHash = HashData(settingsHash, LiqType, (maxLiqTypeId + 1) * sizeof(uint16));
+
+    if (CONF_incremental)
+        LoadSourceHashes();
+
+    int threads = CONF_threads;
+    if (threads <= 0)
+    {
+        long processors = ACE_OS::num_processors_online();
+        threads = processors > 0 ? int(processors) : 1;
+    }
+
+    printf("Convert map files using %d threads\n", threads);
+
+    ADTConvertQueue queue(threads * 2);
+    std::vector<ADTConverter*> converters;
+    for (int i = 0; i < threads; ++i)
+        converters.push_back(new ADTConverter(queue, build));
+
+    uint32 skipped = 0;
     for (uint32 z = 0; z < map_count; ++z)
     {
         printf("Extract %s (%d/%d)                  \n", map_ids[z].name, z + 1, map_count);
@@ -978,12 +1199,54 @@ void ExtractMapsFromMpq(uint32 build)
                     continue;
                 sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map_ids[z].name, map_ids[z].name, x, y);
                 sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map_ids[z].id, y, x);
-                ConvertADT(mpq_filename, output_filename, y, x, build);
+
+                ADT_file* adt = new ADT_file();
+                if (!adt->loadFile(mpq_filename))
+                {
+                    delete adt;
+                    continue;
+                }
+
+                uint32 tileKey = (map_ids[z].id << 16) | (y << 8) | x;
+                uint64 sourceHash = HashData(settingsHash, adt->GetData(), adt->GetDataSize());
+
+                if (CONF_incremental && FileExists(output_filename))
+                {
+                    ACE_Guard<ACE_Thread_Mutex> guard(sourceHashLock);
+                    SourceHashMap::const_iterator itr = sourceHashes.find(tileKey);
+                    if (itr != sourceHashes.end() && itr->second == sourceHash)
+                    {
+                        delete adt;
+                        ++skipped;
+                        continue;
+                    }
+                }
+
+                ADTConvertJob* job = new ADTConvertJob();
+                job->adt = adt;
+                job->mpqName = mpq_filename;
+                job->outputName = output_filename;
+                job->tileKey = tileKey;
+                job->sourceHash = sourceHash;
+                queue.Push(job);
             }
             // draw progress bar
             printf("Processing........................%d%%\r", (100 * (y + 1)) / WDT_MAP_SIZE);
         }
     }
+
+    queue.Close();
+    for (std::vector<ADTConverter*>::iterator itr = converters.begin(); itr != converters.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
+    }
+
+    SaveSourceHashes();
+
+    if (CONF_incremental)
+        printf("%u unchanged map tiles skipped\n", skipped);
+
     delete [] areas;
     delete [] map_ids;
 }
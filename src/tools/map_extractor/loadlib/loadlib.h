@@ -77,7 +77,7 @@ class FileLoader
 
         file_MVER* version;
         FileLoader();
-        ~FileLoader();
+        virtual ~FileLoader();
         bool loadFile(char* filename, bool log = true);
         virtual void free();
 };
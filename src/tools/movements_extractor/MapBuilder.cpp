@@ -24,6 +24,8 @@
 #include "DetourNavMeshBuilder.h"
 #include "DetourCommon.h"
 
+#include "Timer.h"
+
 using namespace VMAP;
 
 namespace MMAP
@@ -139,96 +141,156 @@ set<uint32>* MapBuilder::getTileList(uint32 mapID)
 }
 
 /**************************************************************************/
-#ifdef unix
+void MapBuilder::addGridBoundTiles(uint32 mapID, set<uint32>* tiles)
+{
+    // make sure we process maps which don't have tiles
+    if (tiles->size())
+        return;
+
+    // convert coord bounds to grid bounds
+    uint32 minX, minY, maxX, maxY;
+    getGridBounds(mapID, minX, minY, maxX, maxY);
+
+    // add all tiles within bounds to tile list.
+    for (uint32 i = minX; i <= maxX; ++i)
+        for (uint32 j = minY; j <= maxY; ++j)
+            tiles->insert(StaticMapTree::packTileID(i, j));
+}
+
+/**************************************************************************/
+static bool TileWeightGreater(const TileBuildRequest& a, const TileBuildRequest& b)
+{
+    return a.weight > b.weight;
+}
+
 void MapBuilder::buildAllMaps(int threads)
 {
     printf ("Using %i threads\n", threads);
 
-    TileList::iterator it = m_tiles.begin();
-    std::set<pid_t> pids;
+    m_tileQueue.clear();
+    m_navMeshParams.clear();
 
-    int ImChild = false;
-    int limit = m_tiles.size() / threads;
-
-    if (threads--)
+    // the .mmap files are cheap, write them up front and only spread the tiles over the threads
+    for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
     {
-        for (int i = 0; i < threads; i++)
+        uint32 mapID = it->first;
+        if (shouldSkipMap(mapID))
+            continue;
+
+        set<uint32>* tiles = it->second;
+        addGridBoundTiles(mapID, tiles);
+        if (!tiles->size())
+            continue;
+
+        dtNavMesh* navMesh = NULL;
+        buildNavMesh(mapID, navMesh);
+        if (!navMesh)
         {
-            if (pid_t pid = fork())
-            {
-                if (pid == -1)
-                    printf("FAILED TO CREATE THREAD!\n");
-                else
-                {
-                    pids.insert(pid);
-                    std::advance(it, limit);
-                }
-            }
-            else
+            printf("[Map %03i] Failed creating navmesh!\n", mapID);
+            continue;
+        }
+
+        m_navMeshParams[mapID] = *navMesh->getParams();
+        dtFreeNavMesh(navMesh);
+
+        uint32 built = 0;
+        for (set<uint32>::iterator tile = tiles->begin(); tile != tiles->end(); ++tile)
+        {
+            uint32 tileX, tileY;
+            StaticMapTree::unpackTileID((*tile), tileX, tileY);
+
+            // tiles left complete by an earlier run are not built again
+            if (shouldSkipTile(mapID, tileX, tileY))
             {
-                ImChild = true;
-                fclose(stdin); // suppresses getchar()
-                break;
+                ++built;
+                continue;
             }
+
+            TileBuildRequest request;
+            request.mapID = mapID;
+            request.tileX = tileX;
+            request.tileY = tileY;
+            request.weight = getTileWeight(mapID, tileX, tileY);
+            m_tileQueue.push_back(request);
         }
-    }
 
-    for (int i = 0; (i < limit || !ImChild) && it != m_tiles.end(); i++, ++it)
-    {
-        uint32 mapID = (*it).first;
-        if (!shouldSkipMap(mapID))
-            buildMap(mapID);
+        printf("[Map %03i] We have %u tiles, %u already built.\n", mapID, (unsigned int)tiles->size(), built);
     }
 
-    if (!ImChild && threads++)
-    {
-        int i = 1, status;
-        for (std::set<pid_t>::iterator it = pids.begin(); it != pids.end(); it++)
-        {
-            printf("waiting for the other thread (%i/%i) to exit...", i + 1, threads);
-            printf("%s\n", *it == waitpid(*it, &status, 0) ? "OK" : "FAIL");
+    // start with the biggest tiles so the run doesn't end on one thread chewing on a continent tile
+    std::stable_sort(m_tileQueue.begin(), m_tileQueue.end(), TileWeightGreater);
 
-            i++;
-        }
+    printf("Building %u tiles...\n", (unsigned int)m_tileQueue.size());
 
-        printf("Building Complete\n");
+    m_nextTile = 0;
+    m_tilesDone = 0;
+    m_queueStartTime = getMSTime();
+
+    std::vector<BuilderThread*> builders;
+    for (int i = 0; i < threads; ++i)
+        builders.push_back(new BuilderThread(this));
+
+    for (std::vector<BuilderThread*>::iterator itr = builders.begin(); itr != builders.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
     }
+
+    m_tileQueue.clear();
+
+    printf("Building Complete\n");
 }
-//#elif _WIN32
-#else
-void MapBuilder::buildAllMaps(int threads)
+
+/**************************************************************************/
+void MapBuilder::processTileQueue()
 {
-    printf ("Using %i threads\n", threads);
+    // navmeshes are only used to validate tiles before they are written, but
+    // adding and removing tiles isn't thread safe so each thread has its own
+    map<uint32, dtNavMesh*> navMeshes;
 
-    std::vector<BuilderThread*> _threads;
+    for (;;)
+    {
+        TileBuildRequest request;
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_tileQueueLock);
+            if (m_nextTile >= m_tileQueue.size())
+                break;
 
-    BuilderThreadPool* pool = threads > 0 ? new BuilderThreadPool() : NULL;
+            request = m_tileQueue[m_nextTile++];
+        }
 
-    for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
-    {
-        uint32 mapID = it->first;
-        if (!shouldSkipMap(mapID))
+        dtNavMesh*& navMesh = navMeshes[request.mapID];
+        if (!navMesh)
         {
-            if (threads > 0)
-                pool->Enqueue(new MapBuildRequest(mapID));
-            else
-                buildMap(mapID);
+            navMesh = dtAllocNavMesh();
+            if (!navMesh->init(&m_navMeshParams.find(request.mapID)->second))
+            {
+                printf("[Map %03i] Failed creating navmesh!\n", request.mapID);
+                dtFreeNavMesh(navMesh);
+                navMesh = NULL;
+                continue;
+            }
         }
-    }
 
-    for (int i = 0; i < threads; ++i)
-        _threads.push_back(new BuilderThread(this, pool->Queue()));
+        // terrain and vmap data are loaded by each tile for itself and not shared between threads:
+        // loadVMap loads into a VMapManager2 of its own whose map trees can't load tiles
+        // concurrently, and the .map files of a tile and its neighbours would have to stay
+        // cached for most of a continent since the queue runs by size, not by position
+        buildTile(request.mapID, request.tileX, request.tileY, navMesh);
 
-    // Free memory
-    for (std::vector<BuilderThread*>::iterator _th = _threads.begin(); _th != _threads.end(); ++_th)
-    {
-        (*_th)->wait();
-        delete *_th;
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_tileQueueLock);
+        ++m_tilesDone;
+
+        uint32 total = m_tileQueue.size();
+        uint64 elapsed = GetMSTimeDiffToNow(m_queueStartTime);
+        uint32 eta = uint32(elapsed * (total - m_tilesDone) / m_tilesDone / IN_MILLISECONDS);
+        printf("[%u/%u] Map %03u tile [%02u,%02u] done, ETA %02u:%02u:%02u\n", m_tilesDone, total,
+               request.mapID, request.tileX, request.tileY, eta / HOUR, (eta % HOUR) / MINUTE, eta % MINUTE);
     }
 
-    delete pool;
+    for (map<uint32, dtNavMesh*>::iterator itr = navMeshes.begin(); itr != navMeshes.end(); ++itr)
+        dtFreeNavMesh(itr->second);
 }
-#endif
 
 /**************************************************************************/
 void MapBuilder::getGridBounds(uint32 mapID, uint32& minX, uint32& minY, uint32& maxX, uint32& maxY)
@@ -291,19 +353,7 @@ void MapBuilder::buildMap(uint32 mapID)
     printf("Building map %03u:\n", mapID);
 
     set<uint32>* tiles = getTileList(mapID);
-
-    // make sure we process maps which don't have tiles
-    if (!tiles->size())
-    {
-        // convert coord bounds to grid bounds
-        uint32 minX, minY, maxX, maxY;
-        getGridBounds(mapID, minX, minY, maxX, maxY);
-
-        // add all tiles within bounds to tile list.
-        for (uint32 i = minX; i <= maxX; ++i)
-            for (uint32 j = minY; j <= maxY; ++j)
-                tiles->insert(StaticMapTree::packTileID(i, j));
-    }
+    addGridBoundTiles(mapID, tiles);
 
     if (!tiles->size())
         return;
@@ -911,9 +961,18 @@ bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY)
         return false;
 
     MmapTileHeader header;
-    fread(&header, sizeof(MmapTileHeader), 1, file);
+    size_t count = fread(&header, sizeof(MmapTileHeader), 1, file);
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
     fclose(file);
 
+    if (count != 1)
+        return false;
+
+    // an interrupted run can leave a truncated tile behind
+    if (fileSize != long(sizeof(MmapTileHeader) + header.size))
+        return false;
+
     if (header.mmapMagic != MMAP_MAGIC || header.dtVersion != DT_NAVMESH_VERSION)
         return false;
 
@@ -923,4 +982,151 @@ bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY)
     return true;
 }
 
+/**************************************************************************/
+bool MapBuilder::packMapArchive(uint32 mapID)
+{
+    char fileName[255];
+    sprintf(fileName, "mmaps/%03u.mmap", mapID);
+
+    MmapArchiveHeader header;
+    FILE* file = fopen(fileName, "rb");
+    if (!file)
+    {
+        printf("[Map %03i] Could not open %s, not packing archive\n", mapID, fileName);
+        return false;
+    }
+
+    size_t count = fread(&header.params, sizeof(dtNavMeshParams), 1, file);
+    fclose(file);
+    if (count != 1)
+    {
+        printf("[Map %03i] Bad navmesh params in %s, not packing archive\n", mapID, fileName);
+        return false;
+    }
+
+    // index the valid tiles first, their data is copied in a second pass
+    vector<string> files;
+    char filter[16];
+    sprintf(filter, "%03u*.mmtile", mapID);
+    getDirContents(files, "mmaps", filter);
+
+    vector<MmapArchiveTile> index;
+    vector<string> tileFiles;
+    uint32 offset = sizeof(MmapArchiveHeader) + files.size() * sizeof(MmapArchiveTile);
+    for (uint32 i = 0; i < files.size(); ++i)
+    {
+        uint32 x = uint32(atoi(files[i].substr(3, 2).c_str()));
+        uint32 y = uint32(atoi(files[i].substr(5, 2).c_str()));
+
+        // file names are MMMYYXX in builder terms, shouldSkipTile() is true for complete and current tiles
+        if (!shouldSkipTile(mapID, y, x))
+        {
+            printf("[Map %03i] Skipping invalid tile %s\n", mapID, files[i].c_str());
+            continue;
+        }
+
+        string tileFile = "mmaps/" + files[i];
+        file = fopen(tileFile.c_str(), "rb");
+        if (!file)
+            continue;
+
+        MmapTileHeader tileHeader;
+        count = fread(&tileHeader, sizeof(MmapTileHeader), 1, file);
+        fclose(file);
+        if (count != 1)
+            continue;
+
+        offset = (offset + MMAP_ARCHIVE_ALIGNMENT - 1) / MMAP_ARCHIVE_ALIGNMENT * MMAP_ARCHIVE_ALIGNMENT;
+
+        MmapArchiveTile tile;
+        tile.tileId = x << 16 | y;
+        tile.offset = offset;
+        tile.size = tileHeader.size;
+        tile.usesLiquids = tileHeader.usesLiquids;
+        index.push_back(tile);
+        tileFiles.push_back(tileFile);
+
+        offset += tileHeader.size;
+    }
+
+    header.tileCount = index.size();
+
+    sprintf(fileName, "mmaps/%03u.mmpak", mapID);
+    FILE* archive = fopen(fileName, "wb");
+    if (!archive)
+    {
+        char message[1024];
+        sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, fileName);
+        perror(message);
+        return false;
+    }
+
+    fwrite(&header, sizeof(MmapArchiveHeader), 1, archive);
+    if (!index.empty())
+        fwrite(&index[0], sizeof(MmapArchiveTile), index.size(), archive);
+
+    vector<unsigned char> data;
+    uint32 position = sizeof(MmapArchiveHeader) + index.size() * sizeof(MmapArchiveTile);
+    for (uint32 i = 0; i < index.size(); ++i)
+    {
+        data.assign(index[i].offset - position, 0);
+        data.resize(data.size() + index[i].size);
+
+        file = fopen(tileFiles[i].c_str(), "rb");
+        bool read = file && fseek(file, sizeof(MmapTileHeader), SEEK_SET) == 0 &&
+                    fread(&data[index[i].offset - position], index[i].size, 1, file) == 1;
+        if (file)
+            fclose(file);
+
+        if (!read)
+        {
+            printf("[Map %03i] Failed reading %s, archive is incomplete!\n", mapID, tileFiles[i].c_str());
+            fclose(archive);
+            remove(fileName);
+            return false;
+        }
+
+        fwrite(&data[0], 1, data.size(), archive);
+        position = index[i].offset + index[i].size;
+    }
+
+    fclose(archive);
+
+    printf("[Map %03i] Packed %u tiles into %s\n", mapID, header.tileCount, fileName);
+    return true;
+}
+
+/**************************************************************************/
+void MapBuilder::packAllMapArchives()
+{
+    vector<string> files;
+    getDirContents(files, "mmaps", "*.mmap");
+    for (uint32 i = 0; i < files.size(); ++i)
+        packMapArchive(uint32(atoi(files[i].substr(0, 3).c_str())));
+}
+
+/**************************************************************************/
+uint32 MapBuilder::getTileWeight(uint32 mapID, uint32 tileX, uint32 tileY)
+{
+    char fileName[255];
+    sprintf(fileName, "maps/%03u%02u%02u.map", mapID, tileY, tileX);
+
+    string vmapTile = "vmaps/" + StaticMapTree::getTileFileName(mapID, tileY, tileX);
+    const char* files[2] = { fileName, vmapTile.c_str() };
+
+    uint32 weight = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        FILE* file = fopen(files[i], "rb");
+        if (!file)
+            continue;
+
+        fseek(file, 0, SEEK_END);
+        weight += uint32(ftell(file));
+        fclose(file);
+    }
+
+    return weight;
+}
+
 }
@@ -31,8 +31,7 @@
 #include "Recast.h"
 #include "DetourNavMesh.h"
 #include <ace/Task.h>
-#include <ace/Activation_Queue.h>
-#include <ace/Method_Request.h>
+#include <ace/Thread_Mutex.h>
 
 using namespace std;
 using namespace VMAP;
@@ -59,6 +58,15 @@ struct Tile
     rcPolyMeshDetail* dmesh;
 };
 
+// one unit of work for the builder threads
+struct TileBuildRequest
+{
+    uint32 mapID;
+    uint32 tileX;
+    uint32 tileY;
+    uint32 weight;                                      // size of the source data, used to build big tiles first
+};
+
 class MapBuilder
 {
     public:
@@ -82,10 +90,20 @@ class MapBuilder
         // builds list of maps, then builds all of mmap tiles (based on the skip settings)
         void buildAllMaps(int threads);
 
+        // worker loop of the builder threads, builds queued tiles until the queue is empty
+        void processTileQueue();
+
+        // packs the .mmap and .mmtile files of a map into a single .mmpak archive
+        bool packMapArchive(uint32 mapID);
+
+        // packs every map found in the mmaps directory
+        void packAllMapArchives();
+
     private:
         // detect maps and tiles
         void discoverTiles();
         set<uint32>* getTileList(uint32 mapID);
+        void addGridBoundTiles(uint32 mapID, set<uint32>* tiles);
 
         void buildNavMesh(uint32 mapID, dtNavMesh*& navMesh);
 
@@ -108,6 +126,7 @@ class MapBuilder
         bool shouldSkipMap(uint32 mapID);
         bool isTransportMap(uint32 mapID);
         bool shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY);
+        uint32 getTileWeight(uint32 mapID, uint32 tileX, uint32 tileY);
 
         TerrainBuilder* m_terrainBuilder;
         TileList m_tiles;
@@ -124,74 +143,32 @@ class MapBuilder
 
         // build performance - not really used for now
         rcContext* m_rcContext;
-};
 
-class MapBuildRequest : public ACE_Method_Request
-{
-    public:
-        MapBuildRequest(uint32 mapId) : _mapId(mapId) {}
-
-        virtual int call()
-        {
-            /// @ Actually a creative way of unabstracting the class and returning a member variable
-            return (int)_mapId;
-        }
-
-    private:
-        uint32 _mapId;
+        // tile queue shared by the builder threads
+        vector<TileBuildRequest> m_tileQueue;
+        map<uint32, dtNavMeshParams> m_navMeshParams;
+        uint32 m_nextTile;
+        uint32 m_tilesDone;
+        uint32 m_queueStartTime;
+        ACE_Thread_Mutex m_tileQueueLock;
 };
 
 class BuilderThread : public ACE_Task_Base
 {
     private:
         MapBuilder* _builder;
-        ACE_Activation_Queue* _queue;
 
     public:
-        BuilderThread(MapBuilder* builder, ACE_Activation_Queue* queue) : _builder(builder), _queue(queue)
+        BuilderThread(MapBuilder* builder) : _builder(builder)
         {
             activate();
         }
 
         int svc()
         {
-            /// @ Set a timeout for dequeue attempts (only used when the queue is empty) as it will never get populated after thread starts
-            ACE_Time_Value timeout(5);
-            ACE_Method_Request* request = NULL;
-            while ((request = _queue->dequeue(&timeout)) != NULL)
-            {
-                _builder->buildMap(request->call());
-                delete request;
-                request = NULL;
-            }
-
+            _builder->processTileQueue();
             return 0;
         }
-
-};
-
-class BuilderThreadPool
-{
-    public:
-        BuilderThreadPool() : _queue(new ACE_Activation_Queue()) {}
-        ~BuilderThreadPool()
-        {
-            _queue->queue()->close();
-            delete _queue;
-        }
-
-        void Enqueue(MapBuildRequest* request)
-        {
-            _queue->enqueue(request);
-        }
-
-        ACE_Activation_Queue* Queue()
-        {
-            return _queue;
-        }
-
-    private:
-        ACE_Activation_Queue* _queue;
 };
 }
 
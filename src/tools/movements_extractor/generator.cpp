@@ -84,6 +84,8 @@ bool handleArgs(int argc, char** argv,
                 bool& debugOutput,
                 bool& silent,
                 bool& bigBaseUnit,
+                bool& packArchive,
+                bool& packOnly,
                 char*& offMeshInputPath)
 {
     char* param = NULL;
@@ -203,6 +205,21 @@ bool handleArgs(int argc, char** argv,
             else
                 printf("invalid option for '--bigBaseUnit', using default false\n");
         }
+        else if (strcmp(argv[i], "--archive") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                return false;
+
+            if (strcmp(param, "true") == 0)
+                packArchive = true;
+            else if (strcmp(param, "false") == 0)
+                packArchive = false;
+            else
+                printf("invalid option for '--archive', using default false\n");
+        }
+        else if (strcmp(argv[i], "--packOnly") == 0)
+            packOnly = true;
         else if (strcmp(argv[i], "--offMeshInput") == 0)
         {
             param = argv[++i];
@@ -258,13 +275,15 @@ int main(int argc, char** argv)
          skipBattlegrounds = false,
          debugOutput = false,
          silent = false,
-         bigBaseUnit = false;
+         bigBaseUnit = false,
+         packArchive = false,
+         packOnly = false;
     char* offMeshInputPath = NULL;
 
     bool validParam = handleArgs(argc, argv, mapnum,
                                  tileX, tileY, threads, maxAngle,
                                  skipLiquid, skipContinents, skipJunkMaps, skipBattlegrounds,
-                                 debugOutput, silent, bigBaseUnit, offMeshInputPath);
+                                 debugOutput, silent, bigBaseUnit, packArchive, packOnly, offMeshInputPath);
 
     if (!validParam)
         return silent ? -1 : finish("You have specified invalid parameters", -1);
@@ -289,12 +308,24 @@ int main(int argc, char** argv)
 
     uint32 start = getMSTime();
 
-    if (tileX > -1 && tileY > -1 && mapnum >= 0)
-        builder.buildSingleTile(mapnum, tileX, tileY);
-    else if (mapnum >= 0)
-        builder.buildMap(uint32(mapnum));
-    else
-        builder.buildAllMaps(threads);
+    // --packOnly converts the existing .mmtile files without building anything
+    if (!packOnly)
+    {
+        if (tileX > -1 && tileY > -1 && mapnum >= 0)
+            builder.buildSingleTile(mapnum, tileX, tileY);
+        else if (mapnum >= 0)
+            builder.buildMap(uint32(mapnum));
+        else
+            builder.buildAllMaps(threads);
+    }
+
+    if (packArchive || packOnly)
+    {
+        if (mapnum >= 0)
+            builder.packMapArchive(uint32(mapnum));
+        else
+            builder.packAllMapArchives();
+    }
 
     if (!silent)
         printf("Finished. MMAPS were built in %u ms!\n", GetMSTimeDiffToNow(start));
@@ -17,24 +17,33 @@
 
 #include <string>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include <ace/OS_NS_unistd.h>
 
 #include "TileAssembler.h"
 
 int main(int argc, char* argv[])
 {
-    if (argc != 3)
+    long processors = ACE_OS::num_processors_online();
+    uint32 threads = processors > 0 ? uint32(processors) : 1;
+
+    if (argc == 5 && strcmp(argv[3], "--threads") == 0 && atoi(argv[4]) > 0)
+        threads = atoi(argv[4]);
+    else if (argc != 3)
     {
         //printf("\nusage: %s <raw data dir> <vmap dest dir> [config file name]\n", argv[0]);
-        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir>" << std::endl;
+        std::cout << "usage: " << argv[0] << " <raw data dir> <vmap dest dir> [--threads <count>]" << std::endl;
         return 1;
     }
 
     std::string src = argv[1];
     std::string dest = argv[2];
 
-    std::cout << "using " << src << " as source directory and writing output to " << dest << std::endl;
+    std::cout << "using " << src << " as source directory and writing output to " << dest << " with " << threads << " threads" << std::endl;
 
-    VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
+    VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest, threads);
 
     if (!ta->convertWorld2())
     {